@@ -28,13 +28,23 @@
 
 #include "DkUtils.h"
 #include "DkSettings.h"
+#include "engine/DkLatency.h"
 
 #pragma warning(push, 0)	// no warnings from includes - begin
 #include <QSettings>
 #include <QDebug>
 #include <QWidget>
+#include <QDir>
 #pragma warning(pop)		// no warnings from includes - end
 
+#ifndef Q_OS_WIN
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
 namespace pong {
 
 // DkArduinoController --------------------------------------------------------------------
@@ -50,7 +60,7 @@ DkArduinoController::~DkArduinoController() {
 
 void DkArduinoController::init() {
 
-	comPort = "COM4";
+	comPort = defaultComPort();
 	stop = false;
 }
 
@@ -60,6 +70,8 @@ void DkArduinoController::readSettings() {
 	settings.beginGroup("DkArduinoController");
 	
 	comPort = settings.value("comPort", comPort).toString();
+	baudRate = settings.value("baudRate", baudRate).toInt();
+	pinMask = settings.value("pinMask", pinMask).toULongLong();
 	
 	settings.endGroup();
 	
@@ -71,6 +83,8 @@ void DkArduinoController::writeSettings() const {
 	settings.beginGroup("DkArduinoController");
 	
 	settings.setValue("comPort", comPort);
+	settings.setValue("baudRate", baudRate);
+	settings.setValue("pinMask", pinMask);
 
 	settings.endGroup();
 
@@ -80,13 +94,64 @@ void DkArduinoController::writeSettings() const {
 void DkArduinoController::run() {
 
 	qDebug() << "starting thread...";
-	
+
+	if (!openPort())
+		return;
+
+	DkSerialParser parser(pinMask);
+	std::vector<quint16> frames;
+	frames.reserve(DkSerialParser::buffer_size / DkSerialParser::frame_size);
+
+	////////////////////////////////
+	for (;;) {
+
+		if (stop)
+			break;
+
+		// read everything that is available at once (blocks until a byte arrives or a timeout to check stop)
+		int size = 0;
+		char* buffer = parser.writeBuffer(size);
+		int read = readPort(buffer, size);
+		qint64 stamp = DkLatency::now();
+
+		if (read < 0) {
+			qDebug() << "cannot read from" << comPort << "- stopping controller";
+			break;
+		}
+		else if (read == 0)
+			continue;
+
+		parser.commit(read);
+
+		// decode all complete frames of this wakeup
+		frames.clear();
+		parser.parse(frames);
+
+		for (unsigned short val : frames)
+			serialValue(val, stamp);
+
+		numFrames = parser.frames();
+		numBadBytes = parser.badBytes();
+		numResyncs = parser.resyncs();
+	}
+
+	closePort();
+}
+
+#ifdef Q_OS_WIN
+
+QString DkArduinoController::defaultComPort() const {
+	return "COM4";
+}
+
+bool DkArduinoController::openPort() {
+
 	std::wstring comPortStd = DkUtils::qStringToStdWString(comPort);
 	hCOM = CreateFileW((LPCWSTR)comPortStd.c_str(), GENERIC_READ | GENERIC_WRITE, 0, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
 
 	if (hCOM == INVALID_HANDLE_VALUE) {
 		qDebug() << "hCOM " << comPort << " is NULL....";
-		return;
+		return false;
 	}
 	else {
 		qDebug() << comPort << "is up and running...\n";
@@ -102,7 +167,7 @@ void DkArduinoController::run() {
 	//printComParams(dcb);
 
 	// set params for serial port communication
-	dcb.BaudRate = CBR_9600;
+	dcb.BaudRate = baudRate;
 	dcb.ByteSize = 8;
 	//dcb.EofChar = 0xFE;		//  - should be that... (small letter thorn)
 	//dcb.ErrorChar = 0x01;		// SOH (start of heading)
@@ -122,37 +187,142 @@ void DkArduinoController::run() {
 	//qDebug() << "\n\ndcb our params ------------------------";
 	//printComParams(dcb);
 
+	// return as soon as bytes are available - or after 100 ms to check if we should stop
+	COMMTIMEOUTS timeouts;
+	FillMemory(&timeouts, sizeof(timeouts), 0);
+	timeouts.ReadIntervalTimeout = MAXDWORD;
+	timeouts.ReadTotalTimeoutMultiplier = MAXDWORD;
+	timeouts.ReadTotalTimeoutConstant = 100;
+
+	if (!SetCommTimeouts(hCOM, &timeouts))
+		qDebug() << "cannot set com timeouts!";
+
 	// clear all operations that were performed _before_ we started...
 	PurgeComm(hCOM, PURGE_RXCLEAR);
 
-	DWORD read;
+	return true;
 
-	////////////////////////////////
-	for (;;) {
+}
 
-		Sleep(5);
-		if (stop)
-			break;
+void DkArduinoController::closePort() {
+
+	if (hCOM != INVALID_HANDLE_VALUE)
+		CloseHandle(hCOM);
+	hCOM = INVALID_HANDLE_VALUE;
+}
 
-		//if (!GetCommModemStatus(hCOM, modemStat))
-		//	printf("error in getCommModemStatus...\n");
+int DkArduinoController::readPort(char* buffer, int size) {
 
-		byte magicByte = 0;
-		ReadFile(hCOM, &magicByte, sizeof(magicByte), &read, NULL);
-		qDebug() << "I read: " << read << "magic byte:" << magicByte;
+	DWORD read = 0;
 
-		if (magicByte == 42) {
-			unsigned short buffer = 0;
-			ReadFile(hCOM, &buffer, sizeof(buffer), &read, NULL);
+	if (!ReadFile(hCOM, buffer, size, &read, NULL))
+		return -1;
 
-			//qDebug() << "buffer" << buffer;
+	return (int)read;
+}
+
+#else
+
+static speed_t baudConstant(int baudRate) {
+
+	switch (baudRate) {
+	case 1200:		return B1200;
+	case 2400:		return B2400;
+	case 4800:		return B4800;
+	case 9600:		return B9600;
+	case 19200:		return B19200;
+	case 38400:		return B38400;
+	case 57600:		return B57600;
+	case 115200:	return B115200;
+	case 230400:	return B230400;
+	}
 
-			serialValue(buffer);
+	qWarning() << "[DkArduinoController] unsupported baud rate" << baudRate << "- using 9600";
+
+	return B9600;
+}
+
+QString DkArduinoController::defaultComPort() const {
+
+	// an empty port is detected when the thread starts
+	return "";
+}
+
+bool DkArduinoController::openPort() {
+
+	QString port = comPort;
+
+	// Arduino Unos show up as ttyACM, clones with FTDI/CH340 chips as ttyUSB
+	if (port.isEmpty()) {
+		QStringList devices = QDir("/dev").entryList(QStringList() << "ttyACM*" << "ttyUSB*", QDir::System, QDir::Name);
+
+		if (devices.isEmpty()) {
+			qDebug() << "no serial device found in /dev";
+			return false;
 		}
+
+		port = "/dev/" + devices.first();
 	}
 
+	fd = ::open(port.toLocal8Bit().constData(), O_RDWR | O_NOCTTY);
+
+	if (fd < 0) {
+		qDebug() << "cannot open" << port << ":" << strerror(errno);
+		return false;
+	}
+
+	termios tio;
+
+	if (tcgetattr(fd, &tio) != 0) {
+		qDebug() << port << "is not a terminal:" << strerror(errno);
+		closePort();
+		return false;
+	}
+
+	// raw 8N1 without flow control
+	cfmakeraw(&tio);
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+
+	// read returns as soon as bytes are available - or after 100 ms to check if we should stop
+	tio.c_cc[VMIN] = 0;
+	tio.c_cc[VTIME] = 1;
+
+	speed_t speed = baudConstant(baudRate);
+	cfsetispeed(&tio, speed);
+	cfsetospeed(&tio, speed);
+
+	if (tcsetattr(fd, TCSANOW, &tio) != 0)
+		qDebug() << "cannot set terminal attributes of" << port << ":" << strerror(errno);
+
+	// clear all operations that were performed _before_ we started...
+	tcflush(fd, TCIFLUSH);
+
+	qDebug() << port << "is up and running at" << baudRate << "baud...";
+
+	return true;
 }
 
+void DkArduinoController::closePort() {
+
+	if (fd >= 0)
+		::close(fd);
+	fd = -1;
+}
+
+int DkArduinoController::readPort(char* buffer, int size) {
+
+	ssize_t read = ::read(fd, buffer, size);
+
+	if (read < 0)
+		return errno == EINTR || errno == EAGAIN ? 0 : -1;
+
+	return (int)read;
+}
+
+#endif
+
+#ifdef Q_OS_WIN
 void DkArduinoController::printComParams(const DCB& dcb) const {
 
 	qDebug() << "BaudRate" << dcb.BaudRate;
@@ -184,13 +354,16 @@ void DkArduinoController::printComParams(const DCB& dcb) const {
 	qDebug() << "XonChar" << dcb.XonChar;
 	qDebug() << "XonLim" << dcb.XonLim;
 }
+#endif
 
-void DkArduinoController::serialValue(unsigned short val) const {
+void DkArduinoController::serialValue(unsigned short val, qint64 stamp) {
 
 	unsigned short value = (val & 0x03ff);
 	unsigned short controller = ((val & 0xfc00) >> 10) ;
 
-	emit controllerSignal((int)controller, (int)value);
+	// only the first value of an empty mailbox queues a signal (and only if the game is paused)
+	if (mailbox.post((int)controller, (int)value, stamp) && wakeOnPost.load())
+		emit valuesAvailable();
 }
 
 }
\ No newline at end of file
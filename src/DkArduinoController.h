@@ -26,9 +26,15 @@
 
 #pragma warning(push, 0)	// no warnings from includes - begin
 #include <QThread>
+#include <atomic>
 #pragma warning(pop)		// no warnings from includes - end
 
+#include "engine/DkSerialParser.h"
+#include "engine/DkMailbox.h"
+
+#ifdef Q_OS_WIN
 #include <windows.h>	// needed to read from serial
+#endif
 
 #ifndef DllExport
 #ifdef DK_DLL_EXPORT
@@ -50,6 +56,26 @@ public:
 	~DkArduinoController();
 
 	void setComPort(const QString& cP) { comPort = cP; };
+	void setBaudRate(int rate) { baudRate = rate; };
+	void setPinMask(quint64 mask) { pinMask = mask; };
+
+	// parser statistics (thread-safe)
+	quint64 frames() const { return numFrames; };
+	quint64 badBytes() const { return numBadBytes; };
+	quint64 resyncs() const { return numResyncs; };
+
+	/**
+	 * The newest value of each pin - take them from the GUI thread.
+	 **/
+	DkMailbox& getMailbox() { return mailbox; };
+
+	/**
+	 * Turns the valuesAvailable signal on or off (thread-safe).
+	 * The game loop takes the values once per tick while the game runs,
+	 * so the signal is only needed to wake up a paused game.
+	 * Take the mailbox after turning it on - values posted before are not signalled.
+	 **/
+	void setWakeOnPost(bool wake) { wakeOnPost.store(wake); };
 
 	void run();
 	void quit() {
@@ -57,18 +83,43 @@ public:
 	}
 	
 signals:
-	void controllerSignal(int controller, int value) const;
+	/**
+	 * Emitted if new values arrive in an empty mailbox and wake on post is on.
+	 * At most one signal is queued until the mailbox is taken.
+	 **/
+	void valuesAvailable() const;
 
 protected:
 	QWidget* parent;
+#ifdef Q_OS_WIN
 	HANDLE hCOM;
+#else
+	int fd = -1;
+#endif
 
 	QString comPort;
+	int baudRate = 9600;
+	quint64 pinMask = DkSerialParser::default_pins;
 	bool stop;
 
+	std::atomic<quint64> numFrames{0};
+	std::atomic<quint64> numBadBytes{0};
+	std::atomic<quint64> numResyncs{0};
+	std::atomic<bool> wakeOnPost{true};
+
+	DkMailbox mailbox;
+
 	void init();
-	void serialValue(unsigned short val) const;
+	void serialValue(unsigned short val, qint64 stamp = 0);
+
+	// platform specific serial I/O
+	bool openPort();
+	void closePort();
+	int readPort(char* buffer, int size);
+	QString defaultComPort() const;
+#ifdef Q_OS_WIN
 	void printComParams(const DCB& dcb) const;
+#endif
 
 	void readSettings();
 	void writeSettings() const;
@@ -0,0 +1,305 @@
+/*******************************************************************************************************
+
+ DkLeaderboard.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+
+#include "DkLeaderboard.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+#include <QFileInfo>
+#include <QDebug>
+#include <algorithm>
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+// DkPlayerStats --------------------------------------------------------------------
+int DkPlayerStats::games() const {
+	return wins + losses;
+}
+
+bool DkPlayerStats::operator<(const DkPlayerStats& o) const {
+
+	if (wins != o.wins)
+		return wins > o.wins;
+
+	int diff = pointsFor - pointsAgainst;
+	int oDiff = o.pointsFor - o.pointsAgainst;
+
+	if (diff != oDiff)
+		return diff > oDiff;
+
+	if (losses != o.losses)
+		return losses < o.losses;
+
+	return name < o.name;
+}
+
+// DkLeaderboard --------------------------------------------------------------------
+void DkLeaderboard::addGame(DkPlayerStats& player, bool won, int pointsFor, int pointsAgainst) {
+
+	// keep this in sync with the SQL of update()
+	if (won) {
+		player.wins++;
+		player.streak = player.streak > 0 ? player.streak + 1 : 1;
+		player.bestStreak = qMax(player.bestStreak, player.streak);
+	}
+	else {
+		player.losses++;
+		player.streak = player.streak < 0 ? player.streak - 1 : -1;
+	}
+
+	player.pointsFor += pointsFor;
+	player.pointsAgainst += pointsAgainst;
+}
+
+void DkLeaderboard::add(const DkScoreRecord& score) {
+
+	DkPlayerStats& winner = mStats[score.winner];
+	winner.name = score.winner;
+	addGame(winner, true, score.winnerPoints, score.looserPoints);
+
+	DkPlayerStats& looser = mStats[score.looser];
+	looser.name = score.looser;
+	addGame(looser, false, score.looserPoints, score.winnerPoints);
+}
+
+std::vector<DkPlayerStats> DkLeaderboard::ranking(int maxPlayers) const {
+
+	std::vector<DkPlayerStats> players;
+	players.reserve(mStats.size());
+
+	for (const DkPlayerStats& s : mStats)
+		players.push_back(s);
+
+	if (maxPlayers > 0 && maxPlayers < (int)players.size()) {
+		std::partial_sort(players.begin(), players.begin() + maxPlayers, players.end());
+		players.resize(maxPlayers);
+	}
+	else
+		std::sort(players.begin(), players.end());
+
+	return players;
+}
+
+int DkLeaderboard::size() const {
+	return mStats.size();
+}
+
+bool DkLeaderboard::createTable(QSqlDatabase& db) {
+
+	if (db.tables().contains("player_stats"))
+		return false;
+
+	QSqlQuery query(db);
+	if (!query.exec("CREATE TABLE IF NOT EXISTS player_stats ("
+					"name TEXT PRIMARY KEY, "
+					"wins INTEGER NOT NULL DEFAULT 0, "
+					"losses INTEGER NOT NULL DEFAULT 0, "
+					"points_for INTEGER NOT NULL DEFAULT 0, "
+					"points_against INTEGER NOT NULL DEFAULT 0, "
+					"streak INTEGER NOT NULL DEFAULT 0, "
+					"best_streak INTEGER NOT NULL DEFAULT 0)")) {
+		qWarning() << "[DkLeaderboard] cannot create player_stats:" << query.lastError();
+		return false;
+	}
+
+	return true;
+}
+
+bool DkLeaderboard::load(QSqlDatabase& db) {
+
+	QSqlQuery query(db);
+	query.setForwardOnly(true);
+
+	if (!query.exec("SELECT name, wins, losses, points_for, points_against, streak, best_streak FROM player_stats")) {
+		qWarning() << "[DkLeaderboard] cannot read player_stats:" << query.lastError();
+		return false;
+	}
+
+	mStats.clear();
+
+	while (query.next()) {
+
+		DkPlayerStats s;
+		s.name = query.value(0).toString();
+		s.wins = query.value(1).toInt();
+		s.losses = query.value(2).toInt();
+		s.pointsFor = query.value(3).toInt();
+		s.pointsAgainst = query.value(4).toInt();
+		s.streak = query.value(5).toInt();
+		s.bestStreak = query.value(6).toInt();
+		mStats.insert(s.name, s);
+	}
+
+	return true;
+}
+
+bool DkLeaderboard::update(QSqlDatabase& db, const DkScoreRecord& score) {
+
+	QSqlQuery insert(db);
+	insert.prepare("INSERT OR IGNORE INTO player_stats(name) VALUES (:name)");
+
+	// the right hand sides see the old values (see addGame)
+	QSqlQuery won(db);
+	won.prepare("UPDATE player_stats SET "
+				"wins = wins + 1, "
+				"points_for = points_for + :points_for, "
+				"points_against = points_against + :points_against, "
+				"best_streak = MAX(best_streak, CASE WHEN streak > 0 THEN streak + 1 ELSE 1 END), "
+				"streak = CASE WHEN streak > 0 THEN streak + 1 ELSE 1 END "
+				"WHERE name = :name");
+
+	QSqlQuery lost(db);
+	lost.prepare("UPDATE player_stats SET "
+				"losses = losses + 1, "
+				"points_for = points_for + :points_for, "
+				"points_against = points_against + :points_against, "
+				"streak = CASE WHEN streak < 0 THEN streak - 1 ELSE -1 END "
+				"WHERE name = :name");
+
+	auto exec = [&](QSqlQuery& q, const QString& name, int pointsFor, int pointsAgainst) {
+
+		insert.bindValue(":name", name);
+
+		if (!insert.exec()) {
+			qWarning() << "[DkLeaderboard] cannot insert" << name << insert.lastError();
+			return false;
+		}
+
+		q.bindValue(":points_for", pointsFor);
+		q.bindValue(":points_against", pointsAgainst);
+		q.bindValue(":name", name);
+
+		if (!q.exec()) {
+			qWarning() << "[DkLeaderboard] cannot update" << name << q.lastError();
+			return false;
+		}
+
+		return true;
+	};
+
+	return exec(won, score.winner, score.winnerPoints, score.looserPoints) &&
+		exec(lost, score.looser, score.looserPoints, score.winnerPoints);
+}
+
+bool DkLeaderboard::rebuild(QSqlDatabase& db, quint64* games) {
+
+	createTable(db);
+
+	// one scan over the history (in insert order for the streaks)
+	QSqlQuery scores(db);
+	scores.setForwardOnly(true);
+
+	if (!scores.exec("SELECT winner_name, looser_name, winner_points, looser_points FROM scores ORDER BY rowid")) {
+		qWarning() << "[DkLeaderboard] cannot read scores:" << scores.lastError();
+		return false;
+	}
+
+	DkLeaderboard board;
+	quint64 numGames = 0;
+
+	while (scores.next()) {
+
+		DkScoreRecord s;
+		s.winner = scores.value(0).toString();
+		s.looser = scores.value(1).toString();
+		s.winnerPoints = scores.value(2).toInt();
+		s.looserPoints = scores.value(3).toInt();
+		board.add(s);
+		numGames++;
+	}
+
+	scores.finish();
+
+	if (games)
+		*games = numGames;
+
+	if (!db.transaction()) {
+		qWarning() << "[DkLeaderboard] cannot start a transaction:" << db.lastError();
+		return false;
+	}
+
+	QSqlQuery query(db);
+
+	if (!query.exec("DELETE FROM player_stats")) {
+		qWarning() << "[DkLeaderboard] cannot clear player_stats:" << query.lastError();
+		db.rollback();
+		return false;
+	}
+
+	query.prepare("INSERT INTO player_stats(name, wins, losses, points_for, points_against, streak, best_streak) "
+				  "VALUES (:name, :wins, :losses, :points_for, :points_against, :streak, :best)");
+
+	for (const DkPlayerStats& s : board.mStats) {
+
+		query.bindValue(":name", s.name);
+		query.bindValue(":wins", s.wins);
+		query.bindValue(":losses", s.losses);
+		query.bindValue(":points_for", s.pointsFor);
+		query.bindValue(":points_against", s.pointsAgainst);
+		query.bindValue(":streak", s.streak);
+		query.bindValue(":best", s.bestStreak);
+
+		if (!query.exec()) {
+			qWarning() << "[DkLeaderboard] cannot write" << s.name << query.lastError();
+			db.rollback();
+			return false;
+		}
+	}
+
+	return db.commit();
+}
+
+bool DkLeaderboard::rebuild(const QString& filePath, quint64* games) {
+
+	if (!QFileInfo(filePath).exists())
+		return false;
+
+	QString connection = "pong-leaderboard";
+	bool rebuilt = false;
+
+	{
+		QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
+		db.setDatabaseName(filePath);
+
+		if (db.open())
+			rebuilt = rebuild(db, games);
+		else
+			qWarning() << "[DkLeaderboard] cannot open" << filePath << db.lastError();
+
+		db.close();
+	}
+
+	QSqlDatabase::removeDatabase(connection);
+
+	return rebuilt;
+}
+
+}
@@ -0,0 +1,146 @@
+/*******************************************************************************************************
+
+ DkLeaderboard.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QString>
+#include <QHash>
+#include <vector>
+#pragma warning(pop)		// no warnings from includes - end
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+class QSqlDatabase;
+
+namespace pong {
+
+/**
+ * A finished game that goes to the scores table.
+ **/
+struct DllExport DkScoreRecord {
+
+	QString winner;
+	QString looser;
+	int winnerPoints = 0;
+	int looserPoints = 0;
+	qint64 queuedNs = 0;	// set by DkScoreWriter::add
+};
+
+/**
+ * Summary of all games of a player (a row of the player_stats table).
+ **/
+struct DllExport DkPlayerStats {
+
+	QString name;
+	int wins = 0;
+	int losses = 0;
+	int pointsFor = 0;
+	int pointsAgainst = 0;
+	int streak = 0;			// > 0: wins in a row, < 0: losses in a row
+	int bestStreak = 0;
+
+	int games() const;
+	bool operator<(const DkPlayerStats& o) const;	// ranking order (best first)
+};
+
+/**
+ * Leaderboard of all players.
+ * The player_stats table is updated with each score (in the same
+ * transaction), so the ranking is never re-aggregated from the
+ * scores table - except by rebuild().
+ **/
+class DllExport DkLeaderboard {
+
+public:
+	DkLeaderboard() {};
+
+	/**
+	 * Adds a game to the in-memory leaderboard.
+	 **/
+	void add(const DkScoreRecord& score);
+
+	/**
+	 * Returns the best players.
+	 * @param maxPlayers the number of players (0: all).
+	 * @return the players in ranking order.
+	 **/
+	std::vector<DkPlayerStats> ranking(int maxPlayers = 0) const;
+	int size() const;
+
+	/**
+	 * Creates the player_stats table if it does not exist.
+	 * @param db an open DB.
+	 * @return true if the table was created (i.e. it needs a rebuild).
+	 **/
+	static bool createTable(QSqlDatabase& db);
+
+	/**
+	 * Reads the player_stats table (one row per player).
+	 * @return true if the table could be read.
+	 **/
+	bool load(QSqlDatabase& db);
+
+	/**
+	 * Adds a game to the player_stats table.
+	 * Call it in the transaction that inserts the score.
+	 * @return true if both players were updated.
+	 **/
+	static bool update(QSqlDatabase& db, const DkScoreRecord& score);
+
+	/**
+	 * Recomputes the player_stats table from the scores table.
+	 * The scores are streamed once (in insert order).
+	 * @param db an open DB.
+	 * @param games returns the number of games that were scanned.
+	 * @return true if the table was rebuilt.
+	 **/
+	static bool rebuild(QSqlDatabase& db, quint64* games = 0);
+
+	/**
+	 * Recomputes the player_stats table of a DB file (see --rebuild-leaderboard).
+	 * @param filePath the SQLite DB.
+	 * @param games returns the number of games that were scanned.
+	 * @return true if the table was rebuilt.
+	 **/
+	static bool rebuild(const QString& filePath, quint64* games = 0);
+
+protected:
+	QHash<QString, DkPlayerStats> mStats;
+
+	static void addGame(DkPlayerStats& player, bool won, int pointsFor, int pointsAgainst);
+};
+
+}
@@ -32,6 +32,7 @@
 #include <QDebug>
 #include <QPointF>
 #include <QPolygonF>
+#include <type_traits>
 #pragma warning(pop)		// no warnings from includes - end
 
 #ifdef QT_NO_DEBUG_OUTPUT
@@ -803,4 +804,159 @@ public:
 
 };
 
+/**
+ * A trivially copyable 2D vector for hot paths.
+ * In contrast to DkVector it has no vtable, so all operations can be inlined.
+ * The interface mirrors DkVector (e.g. normalize, rotate, angle).
+ */
+struct DllExport Vec2f {
+
+	float x;	/**< the vector's x-coordinate*/
+	float y;	/**< the vector's y-coordinate*/
+
+	/** 
+	 * Default constructor (coordinates are not initialized).
+	 **/
+	Vec2f() = default;
+
+	/** 
+	 * Initializes an object.
+	 * @param x the vector's x-coordinate.
+	 * @param y the vector's y-coordinate.
+	 **/
+	constexpr Vec2f(float x, float y) : x(x), y(y) {};
+
+	/**
+	 * Initializes the vector by means of a DkVector.
+	 * @param v a DkVector
+	 **/ 
+	explicit Vec2f(const DkVector& v) : x(v.x), y(v.y) {};
+
+	/**
+	 * Initializes the vector by means of a QPointF.
+	 * @param p a QPointF
+	 **/ 
+	explicit Vec2f(const QPointF& p) : x((float)p.x()), y((float)p.y()) {};
+
+	DkVector toDkVector() const {
+		return DkVector(x, y);
+	};
+
+	QPointF toQPointF() const {
+		return QPointF(x, y);
+	};
+
+	constexpr bool operator== (const Vec2f& vec) const {
+		return x == vec.x && y == vec.y;
+	};
+
+	constexpr bool operator!= (const Vec2f& vec) const {
+		return x != vec.x || y != vec.y;
+	};
+
+	constexpr Vec2f operator+ (const Vec2f& vec) const {
+		return Vec2f(x+vec.x, y+vec.y);
+	};
+
+	constexpr Vec2f operator- (const Vec2f& vec) const {
+		return Vec2f(x-vec.x, y-vec.y);
+	};
+
+	constexpr Vec2f operator- () const {
+		return Vec2f(-x, -y);
+	};
+
+	constexpr Vec2f operator* (float scalar) const {
+		return Vec2f(x*scalar, y*scalar);
+	};
+
+	constexpr Vec2f operator/ (float scalar) const {
+		return Vec2f(x/scalar, y/scalar);
+	};
+
+	void operator+= (const Vec2f& vec) {
+		x += vec.x;
+		y += vec.y;
+	};
+
+	void operator-= (const Vec2f& vec) {
+		x -= vec.x;
+		y -= vec.y;
+	};
+
+	void operator*= (float scalar) {
+		x *= scalar;
+		y *= scalar;
+	};
+
+	void operator/= (float scalar) {
+		x /= scalar;
+		y /= scalar;
+	};
+
+	/** 
+	 * Scalar product.
+	 * @return the scalar product of vec and the current vector.
+	 */ 
+	constexpr float dot(const Vec2f& vec) const {
+		return x*vec.x + y*vec.y;
+	};
+
+	constexpr bool isEmpty() const {
+		return x == 0 && y == 0;
+	};
+
+	/** 
+	 * The vector norm.
+	 * @return the vector norm of the current vector.
+	 */
+	float norm() const {
+		return sqrt(x*x + y*y);
+	};
+
+	/** 
+	 * Normalizes the vector.
+	 * After normalization the vector's magnitude is |v| = 1
+	 */
+	void normalize() {
+		float n = norm();
+		x /= n;
+		y /= n;
+	};
+
+	/**
+	 * Returns the vector's angle in radians.
+	 * The angle is computed by: atan2(y,x).
+	 * @return the vector's angle in radians.
+	 **/
+	double angle() const {
+		return atan2(y, x);
+	};
+
+	/**
+	 * Rotates the vector by a specified angle in radians.
+	 * The rotation matrix is: R(-theta) = [cos sin; -sin cos]
+	 * @param angle the rotation angle in radians.
+	 **/
+	void rotate(double angle) {
+
+		double c = cos(angle);
+		double s = sin(angle);
+		float xtmp = x;
+		x = (float) ( xtmp*c+y*s);
+		y = (float) (-xtmp*s+y*c);
+	};
+
+	/**
+	 * Rounds both coordinates (same as QPointF::toPoint).
+	 **/
+	Vec2f round() const {
+		return Vec2f((float)qRound(x), (float)qRound(y));
+	};
+};
+
+static_assert(std::is_trivially_copyable<Vec2f>::value, "Vec2f must be trivially copyable");
+static_assert(std::is_standard_layout<Vec2f>::value, "Vec2f must have a standard layout");
+
 }
+
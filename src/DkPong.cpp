@@ -27,6 +27,8 @@
 #include "DkPong.h"
 
 #include "DkArduinoController.h"
+#include "DkRenderThread.h"
+#include "DkScoreWriter.h"
 #include "DkSettings.h"
 
 #pragma warning(push, 0)	// no warnings from includes - begin
@@ -37,6 +39,7 @@
 #include <QTime>
 #include <QApplication>
 #include <QDesktopWidget>
+#include <QScreen>
 #include <QSettings>
 #include <QSound>
 #include <QSqlQuery>
@@ -44,6 +47,11 @@
 #include <QHBoxLayout>
 #include <QFileInfo>
 #include <QDir>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QFontDatabase>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 #include <algorithm>
 #include <cmath>
 #pragma warning(pop)		// no warnings from includes - end
@@ -56,22 +64,6 @@ DkPongSettings::DkPongSettings() {
 	loadSettings();
 }
 
-void DkPongSettings::setField(const QRect & field) {
-	mField = field;
-}
-
-QRect DkPongSettings::field() const {
-	return mField;
-}
-
-void DkPongSettings::setUnit(int unit) {
-	mUnit = unit;
-}
-
-int DkPongSettings::unit() const {
-	return mUnit;
-}
-
 void DkPongSettings::setBackgroundColor(const QColor & col) {
 	mBgCol = col;
 }
@@ -88,14 +80,6 @@ QColor DkPongSettings::foregroundColor() const {
 	return mFgCol;
 }
 
-void DkPongSettings::setTotalScore(int maxScore) {
-	mTotalScore = maxScore;
-}
-
-int DkPongSettings::totalScore() const {
-	return mTotalScore;
-}
-
 void DkPongSettings::writeSettings() {
 
 	QSettings& settings = Settings::instance().getSettings();
@@ -125,6 +109,7 @@ void DkPongSettings::writeSettings() {
 	settings.setValue("player2SelectPin", mPlayer2SelectPin);
 
 	settings.setValue("dbName", mDBName);
+	settings.setValue("inputFilter", mInputFilter);
 	//settings.setValue("speed", mSpeed);
 
 	settings.endGroup();
@@ -172,18 +157,6 @@ int DkPongSettings::player2SelectPin() const {
 	return mPlayer2SelectPin;
 }
 
-void DkPongSettings::setSpeed(float speed) {
-	mSpeed = speed;
-}
-
-float DkPongSettings::speed() const {
-	return mSpeed;
-}
-
-float DkPongSettings::playerRatio() const {
-	return mPlayerRatio;
-}
-
 QString DkPongSettings::DBPath() const {
 	return mDBName;
 }
@@ -210,6 +183,7 @@ void DkPongSettings::loadSettings() {
 	mPlayer2SelectPin = settings.value("player2SelectPin", mPlayer2SelectPin).toInt();
 
 	mDBName = settings.value("dbName", mDBName).toString();
+	mInputFilter = settings.value("inputFilter", mInputFilter).toBool();
 	//mSpeed = settings.value("speed", mSpeed).toFloat();
 
 	int bgAlpha = settings.value("backgroundAlpha", mBgCol.alpha()).toInt();
@@ -225,44 +199,15 @@ void DkPongSettings::loadSettings() {
 }
 
 // DkPlayer --------------------------------------------------------------------
-DkPongPlayer::DkPongPlayer(const QString& playerName, const QString& soundFile, QSharedPointer<DkPongSettings> settings, QObject* parent) : QObject(parent) {
+DkPongPlayer::DkPongPlayer(const QString& playerName, const QString& soundFile, QSharedPointer<DkPongSettings> settings, QObject* parent) : QObject(parent), DkEnginePlayer(settings) {
 
 	mPlayerName = playerName;
-	mS = settings;
-	mSpeed = 0;
-	mPos = INT_MAX;
-	mRect = QRect(QPoint(), QSize(settings->unit(), 2*settings->unit()));
 
 	// sound
 	mSound = new QSound(soundFile, this);
 
 }
 
-void DkPongPlayer::reset(const QPoint& pos) {
-
-	// only reset if we don't have controller
-	if (mControllerPos == -1)
-		mRect.moveCenter(pos);
-	//else
-	//	mRect.moveCenter(QPoint(pos.x(), qRound(mControllerPos)));
-}
-
-int DkPongPlayer::pos() const {
-	return mPos;
-}
-
-QRect DkPongPlayer::rect() const {
-	return mRect;
-}
-
-void DkPongPlayer::setHeight(int newHeight) {
-	mRect.setHeight(newHeight);
-}
-
-int DkPongPlayer::velocity() const {
-	return mVelocity;
-}
-
 void DkPongPlayer::sound() const {
 
 	if (mSound)
@@ -270,60 +215,6 @@ void DkPongPlayer::sound() const {
 
 }
 
-void DkPongPlayer::move() {
-
-	int oldTop = mRect.top();
-
-	// arduino controlls
-	if (mControllerPos != -1) {
-		mRect.moveTop(qRound((1-mControllerPos)*(mS->field().height()-mRect.height())));
-		mVelocity = oldTop - mRect.top();
-		return;
-	}
-
-	if (mRect.top() + mSpeed < 0)
-		mRect.moveTop(0);
-	else if (mRect.bottom() + mSpeed > mS->field().height())
-		mRect.moveBottom(mS->field().height());
-	else
-		mRect.moveTop(mRect.top() + mSpeed);
-
-	mVelocity = oldTop - mRect.top();
-}
-
-void DkPongPlayer::setSpeed(int speed) {
-	
-	mSpeed = speed;
-
-	if (speed != 0)
-		mPos = mRect.center().y();
-	else
-		mPos = INT_MAX;
-}
-
-void DkPongPlayer::setPos(float pos) {
-
-	mControllerPos = pos;
-	move();
-	emit updatePaint();
-}
-
-void DkPongPlayer::updateSize() {
-	mRect.setHeight(qRound(mS->field().height()*mS->playerRatio()));
-}
-
-void DkPongPlayer::increaseScore() {
-	mScore++;
-}
-
-void DkPongPlayer::resetScore() {
-	mScore = 0;
-}
-
-int DkPongPlayer::score() const {
-	return mScore;
-}
-
 void DkPongPlayer::setName(const QString & name) {
 	mPlayerName = name;
 }
@@ -340,45 +231,49 @@ DkScoreLabel::DkScoreLabel(Qt::Alignment align, QWidget* parent, QSharedPointer<
 	setStyleSheet("QLabel{ color: #fff;}");
 	setAlignment(Qt::AlignHCenter | Qt::AlignTop);
 	
-	mFont = QFont("terminal", 6);
+	mFont = DkFrameRenderer::font();
 	setFont(mFont);
 	qDebug() << "using:" << mFont.family();
 }
 
-void DkScoreLabel::paintEvent(QPaintEvent* /*ev*/) {
+QCache<QString, QPixmap>& DkScoreLabel::cache() {
 
-	QFontMetrics m(mFont);
-	
-	QPixmap buffer(m.width(text())-1, m.height());
-	buffer.fill(Qt::transparent);
-	//buffer.fill(Qt::red);
+	// shared by all labels, the cost is in KB
+	static QCache<QString, QPixmap> c(16*1024);
+	return c;
+}
 
-	// draw font
-	QPen fontPen(mS->foregroundColor());
+void DkScoreLabel::clearCache() {
+	cache().clear();
+}
 
-	QPainter bp(&buffer);
-	bp.setPen(fontPen);
-	bp.setFont(mFont);
-	bp.drawText(buffer.rect(), Qt::AlignHCenter | Qt::AlignVCenter, text());
-	bp.end();
+void DkScoreLabel::setExternalRendering(bool external) {
+	mExternal = external;
+}
 
-	QSize bSize(size());
-	bSize.setHeight(qRound(bSize.height() - mS->unit()*0.5));
-	buffer = buffer.scaled(bSize, Qt::KeepAspectRatio);
+Qt::Alignment DkScoreLabel::textAlignment() const {
+	return mAlign;
+}
 
-	QRect r(buffer.rect());
+void DkScoreLabel::paintEvent(QPaintEvent* /*ev*/) {
 
-	if (mAlign & Qt::AlignRight)
-		r.moveLeft(width() - (mS->unit() * 3 + buffer.width()));
-	else if (mAlign & Qt::AlignHCenter)
-		r.moveLeft(qRound((width() - buffer.width())*0.5f));
-	else
-		r.moveLeft(mS->unit() * 3);
+	// the text is drawn by the render thread
+	if (mExternal)
+		return;
 
-	if (mAlign & Qt::AlignBottom)
-		r.moveBottom(height());
-	else
-		r.moveTop(qRound((height()-buffer.height())/2.0f));	// default: center
+	QString key = DkFrameRenderer::textKey(text(), size(), mS->foregroundColor(), mS->unit());
+	QPixmap buffer;
+
+	if (QPixmap* cached = cache().object(key))
+		buffer = *cached;
+	else {
+		buffer = QPixmap::fromImage(DkFrameRenderer::renderText(text(), size(), mS->foregroundColor(), mS->unit()));
+
+		// insert() takes ownership (and deletes pixmaps that are too large)
+		cache().insert(key, new QPixmap(buffer), qMax(buffer.width()*buffer.height()*4/1024, 1));
+	}
+
+	QRect r = DkFrameRenderer::textRect(buffer.size(), size(), mAlign, mS->unit());
 
 	QPainter p(this);
 	p.drawPixmap(r, buffer);
@@ -395,13 +290,27 @@ DkPongPort::DkPongPort(QWidget *parent, Qt::WindowFlags) : QGraphicsView(parent)
 	mPlayerSpeed = qRound(mS->field().width()*0.007);
 
 	mBall = DkBall(mS);
+	mSeed = DkRandom::randomSeed();
+	mReplayDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/replays";
 	mPlayer1 = new DkPongPlayer(mS->player1Name(), ":/pong/audio/player1-collision.wav", mS);
 	mPlayer2 = new DkPongPlayer(mS->player2Name(), ":/pong/audio/player2-collision.wav",  mS);
 
-	mP1Score = new DkScoreLabel(Qt::AlignRight, this, mS);
-	mP2Score = new DkScoreLabel(Qt::AlignLeft, this, mS);
-	mLargeInfo = new DkScoreLabel(Qt::AlignHCenter | Qt::AlignBottom, this, mS);
-	mSmallInfo = new DkScoreLabel(Qt::AlignHCenter, this, mS);
+	mP1Score = new DkScoreLabel(DkFrameRenderer::labelAlignment(DkFrameRenderer::label_score1), this, mS);
+	mP2Score = new DkScoreLabel(DkFrameRenderer::labelAlignment(DkFrameRenderer::label_score2), this, mS);
+	mLargeInfo = new DkScoreLabel(DkFrameRenderer::labelAlignment(DkFrameRenderer::label_large_info), this, mS);
+	mSmallInfo = new DkScoreLabel(DkFrameRenderer::labelAlignment(DkFrameRenderer::label_small_info), this, mS);
+
+	mPerfOverlay = new QLabel(this);
+	mPerfOverlay->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+	mPerfOverlay->setStyleSheet(QString("QLabel{ color: %1; background-color: rgba(0,0,0,150); padding: 4px;}").arg(mS->foregroundColor().name()));
+	mPerfOverlay->setAttribute(Qt::WA_TransparentForMouseEvents);
+	mPerfOverlay->hide();
+
+	mLeaderboard = new QLabel(this);
+	mLeaderboard->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+	mLeaderboard->setStyleSheet(QString("QLabel{ color: %1; background-color: rgba(0,0,0,150); padding: 6px;}").arg(mS->foregroundColor().name()));
+	mLeaderboard->setAttribute(Qt::WA_TransparentForMouseEvents);
+	mLeaderboard->hide();
 	 
 	QVBoxLayout *layout = new QVBoxLayout(this);
 	layout->setContentsMargins(0, 0, 0, 0);
@@ -414,19 +323,27 @@ DkPongPort::DkPongPort(QWidget *parent, Qt::WindowFlags) : QGraphicsView(parent)
 	connect(mHighscores, &DkHighscores::playerChanged, this, &DkPongPort::playerChanged);
 
 
+	// the timer only drives the frames - the physics run with a fixed timestep (see gameLoop)
+	qreal refreshRate = QGuiApplication::primaryScreen() ? QGuiApplication::primaryScreen()->refreshRate() : 60.0;
 	mEventLoop = new QTimer(this);
-	mEventLoop->setInterval(10);
-	//eventLoop->start();
+	mEventLoop->setTimerType(Qt::PreciseTimer);
+	mEventLoop->setInterval(qMax(qRound(1000.0 / qMax(refreshRate, 1.0)), 1));
+	mClock.start();
 
 	mCountDownTimer = new QTimer(this);
 	mCountDownTimer->setInterval(500);
 
+	mPerfTimer = new QTimer(this);
+	mPerfTimer->setInterval(500);
+	connect(mPerfTimer, SIGNAL(timeout()), this, SLOT(updatePerfOverlay()));
+
 	mController = new DkArduinoController(this);
-	connect(mController, SIGNAL(controllerSignal(int, int)), this, SLOT(controllerUpdate(int ,int)));
+	connect(mController, SIGNAL(valuesAvailable()), this, SLOT(takeControllerValues()));
 
 	connect(mEventLoop, SIGNAL(timeout()), this, SLOT(gameLoop()));
 	connect(mCountDownTimer, SIGNAL(timeout()), this, SLOT(countDown()));
 
+	setRenderThread(true);
 	initGame();
 	pauseGame();
 
@@ -447,6 +364,7 @@ void DkPongPort::initGame() {
 		mP2Score->setText(QString::number(mPlayer2->score()));
 	}
 
+	keepState();
 	update();
 }
 
@@ -471,10 +389,15 @@ void DkPongPort::pauseGame(bool pause) {
 	if (pause) {
 		mCountDownTimer->stop();
 		mEventLoop->stop();
+		mAlpha = 1.0;
+
+		// nobody takes the controller values in the game loop now
+		if (mController) {
+			mController->setWakeOnPost(true);
+			QMetaObject::invokeMethod(this, "takeControllerValues", Qt::QueuedConnection);
+		}
 		mLargeInfo->setText(tr("PAUSED"));
 		mSmallInfo->setText(tr("Press <SPACE> to start."));
-		connect(mPlayer1, SIGNAL(updatePaint()), this, SLOT(update()), Qt::UniqueConnection);
-		connect(mPlayer2, SIGNAL(updatePaint()), this, SLOT(update()), Qt::UniqueConnection);
 	}
 	// start the game
 	else {
@@ -486,16 +409,156 @@ void DkPongPort::pauseGame(bool pause) {
 			mPlayer1->resetScore();
 			mPlayer2->resetScore();
 			initGame();
+			mNewMatch = true;
 		}
 
+		if (mNewMatch)
+			newMatch();
+
+		// do not catch up the time we were paused
+		mStep.reset(mClock.nsecsElapsed());
+		mFrameStats.breakInterval();
+		mAlpha = 0.0;
+
+		// tick takes the controller values
+		if (mController)
+			mController->setWakeOnPost(false);
+
 		mEventLoop->start();
-		disconnect(mPlayer1, SIGNAL(updatePaint()), this, SLOT(update()));
-		disconnect(mPlayer2, SIGNAL(updatePaint()), this, SLOT(update()));
 	}
 
 	mHighscores->setVisible(pause);
 	mLargeInfo->setVisible(pause);
 	mSmallInfo->setVisible(pause);
+
+	if (pause)
+		updateLeaderboard();
+	else
+		mLeaderboard->hide();
+
+	// the overlay changed
+	mFullUpdate = true;
+	updateDirty();
+}
+
+void DkPongPort::newMatch() {
+
+	mNewMatch = false;
+
+	// restore the recorded match
+	if (mReplay.isOpen()) {
+
+		const DkReplayHeader& h = mReplay.header();
+		mReplay.rewind();
+
+		if (mS->field().size() != QSize(h.fieldWidth, h.fieldHeight))
+			qWarning() << "the replay was recorded with a" << h.fieldWidth << "x" << h.fieldHeight << "field - it will diverge";
+
+		mS->setUnit(h.unit);
+		mS->setTotalScore(h.totalScore);
+		mS->setPlayerRatio(h.playerRatio);
+		mS->setSpeed(h.speed);
+		mS->setInputFilter(h.inputFilter);
+		mPlayer1->updateSize();
+		mPlayer2->updateSize();
+		initGame();
+
+		mBall.setSeed(h.seed);
+		mPlayer1->setState(h.player1);
+		mPlayer2->setState(h.player2);
+		qInfo().noquote() << "replaying match with seed:" << h.seed;
+		return;
+	}
+
+	quint64 seed = DkRandom::matchSeed(mSeed, mMatchIdx);
+	mBall.setSeed(seed);
+
+	// print the seed so that the match can be reproduced
+	qInfo().noquote() << "match" << mMatchIdx << "seed:" << seed;
+	mMatchIdx++;
+
+	// replays start with empty filters
+	mPlayer1->resetFilter();
+	mPlayer2->resetFilter();
+
+	if (!mReplayDir.isEmpty()) {
+
+		DkReplayHeader h;
+		h.seed = seed;
+		h.fromSettings(*mS);
+		h.player1 = mPlayer1->state();
+		h.player2 = mPlayer2->state();
+		mRecorder.start(h);
+	}
+}
+
+void DkPongPort::setReplayDir(const QString& dirPath) {
+	mReplayDir = dirPath;
+}
+
+QString DkPongPort::replayPath() const {
+
+	QString fileName = QDateTime::currentDateTime().toString("yyyy-MM-dd-HH-mm-ss") + "-" + QString::number(mBall.seed()) + ".pongreplay";
+	return QDir(mReplayDir).absoluteFilePath(fileName);
+}
+
+bool DkPongPort::playReplay(const QString& filePath) {
+
+	if (!mReplay.open(filePath))
+		return false;
+
+	const DkReplayHeader& h = mReplay.header();
+	qInfo().noquote() << "replay" << filePath << ":" << h.ticks << "ticks, score" << h.score1 << ":" << h.score2;
+
+	// the simulation needs the recorded field
+	window()->setFixedSize(h.fieldWidth, h.fieldHeight);
+
+	mRecorder.discard();
+	mNewMatch = true;
+
+	return true;
+}
+
+bool DkPongPort::isReplaying() const {
+	return mReplay.isOpen();
+}
+
+void DkPongPort::setPlayerPos(DkPongPlayer* player, float pos) {
+
+	if (mReplay.isOpen())
+		return;
+
+	player->setPos(pos);
+	mRecorder.addInput(player == mPlayer1 ? DkReplay::input_player1_pos : DkReplay::input_player2_pos, pos);
+}
+
+void DkPongPort::setPlayerSpeed(DkPongPlayer* player, int speed) {
+
+	if (mReplay.isOpen())
+		return;
+
+	player->setSpeed(speed);
+	mRecorder.addInput(player == mPlayer1 ? DkReplay::input_player1_speed : DkReplay::input_player2_speed, (float)speed);
+}
+
+void DkPongPort::setBallSpeed(float speed) {
+
+	if (mReplay.isOpen())
+		return;
+
+	mBall.setSpeed(speed);
+	mRecorder.addInput(DkReplay::input_ball_speed, speed);
+}
+
+void DkPongPort::setSeed(quint64 seed) {
+
+	mSeed = seed;
+	mMatchIdx = 0;
+	mNewMatch = true;
+}
+
+quint64 DkPongPort::matchSeed() const {
+	return mBall.seed();
 }
 
 void DkPongPort::playerChanged(Screen screen, const QString& name) {
@@ -515,6 +578,10 @@ DkArduinoController* DkPongPort::getController() {
 	return mController;
 }
 
+DkHighscores* DkPongPort::highscores() {
+	return mHighscores;
+}
+
 DkPongPlayer * DkPongPort::player1() {
 	return mPlayer1;
 }
@@ -523,24 +590,55 @@ DkPongPlayer * DkPongPort::player2() {
 	return mPlayer2;
 }
 
+const DkFixedStep& DkPongPort::clock() const {
+	return mStep;
+}
+
 QSharedPointer<DkPongSettings> DkPongPort::settings() const {
 	return mS;
 }
 
-void DkPongPort::controllerUpdate(int controller, int val) {
+void DkPongPort::takeControllerValues() {
+
+	int values[DkMailbox::max_pins];
+	qint64 stamps[DkMailbox::max_pins];
+	quint64 mask = mController->getMailbox().take(values, stamps);
+	bool changed = mask != 0;
+
+	for (int pin = 0; mask; pin++, mask >>= 1) {
+		if (mask & 1)
+			controllerUpdate(pin, values[pin], stamps[pin]);
+	}
+
+	// the game loop repaints if it's running
+	if (changed && !mEventLoop->isActive())
+		updateDirty();
+}
+
+void DkPongPort::controllerUpdate(int controller, int val, qint64 stamp) {
 
-	qDebug() << "pin" << controller << "value" << val;
 	// convert value
 	float minV = 0.0f;
 	float maxV = 1023.0f;
 	float v = (val - minV) / (maxV - minV);
 
-	if (controller == mS->player1Pin())
-		mPlayer1->setPos(v);
-	else if (controller == mS->player2Pin())
-		mPlayer2->setPos(v);
+	if (controller == mS->player1Pin()) {
+		dispatched(0, stamp);
+		setPlayerPos(mPlayer1, v);
+
+		// unfiltered paddles move right away (see DkEnginePlayer::setPos)
+		if (!mS->inputFilter())
+			simulated(0);
+	}
+	else if (controller == mS->player2Pin()) {
+		dispatched(1, stamp);
+		setPlayerPos(mPlayer2, v);
+
+		if (!mS->inputFilter())
+			simulated(1);
+	}
 	else if (controller == mS->speedPin()) {
-		mBall.setAnalogueSpeed(v);
+		setBallSpeed(mBall.analogueSpeed(v));
 	} 
 	else if (controller == mS->pausePin()) {
 		if (mEventLoop->isActive())
@@ -556,8 +654,67 @@ void DkPongPort::controllerUpdate(int controller, int val) {
 	}
 }
 
+void DkPongPort::dispatched(int playerIdx, qint64 stamp) {
+
+	if (!stamp)
+		return;
+
+	qint64 now = DkLatency::now();
+	mLatency.add(DkLatency::stage_read_dispatch, now - stamp);
+
+	// the paddle is only simulated if the game is running
+	if (mEventLoop->isActive())
+		mDispatchNs[playerIdx] = now;
+}
+
+void DkPongPort::simulated(int playerIdx) {
+
+	if (!mDispatchNs[playerIdx])
+		return;
+
+	qint64 now = DkLatency::now();
+	mLatency.add(DkLatency::stage_dispatch_sim, now - mDispatchNs[playerIdx]);
+	mDispatchNs[playerIdx] = 0;
+	mSimNs[playerIdx] = now;
+	mSimTick[playerIdx] = mTick;
+}
+
+void DkPongPort::painted(quint64 tick) {
+
+	qint64 now = 0;
+
+	for (int idx = 0; idx < 2; idx++) {
+
+		// the frame on screen might be older than the paddle's position (render thread)
+		if (!mSimNs[idx] || tick < mSimTick[idx])
+			continue;
+
+		if (!now)
+			now = DkLatency::now();
+
+		mLatency.add(DkLatency::stage_sim_paint, now - mSimNs[idx]);
+		mSimNs[idx] = 0;
+	}
+}
+
+void DkPongPort::setLatencyLog(const QString& filePath) {
+	mLatencyLog = filePath;
+}
+
+const DkLatency& DkPongPort::latency() const {
+	return mLatency;
+}
+
+void DkPongPort::writeLatency() const {
+
+	qInfo().noquote() << "input latency:\n" + mLatency.summary();
+
+	if (!mLatencyLog.isEmpty())
+		mLatency.save(mLatencyLog);
+}
+
 void DkPongPort::changeSpeed(int val) {
-	mBall.setSpeed(val + mBall.speed());
+	setBallSpeed(val + mBall.speed());
 }
 
 void DkPongPort::countDown() {
@@ -574,18 +731,38 @@ void DkPongPort::countDown() {
 
 void DkPongPort::paintEvent(QPaintEvent* event) {
 
+	qint64 paintStart = mClock.nsecsElapsed();
+
 	// propagate
 	QGraphicsView::paintEvent(event);
 
+	if (mRenderThread) {
+		drawFrame(event);
+		painted(mFrameState.tick);
+		mFrameStats.addPaint(mClock.nsecsElapsed() - paintStart);
+		return;
+	}
+
 	QPainter p(viewport());
 	p.setBackgroundMode(Qt::TransparentMode);
 
-	p.fillRect(QRect(QPoint(), size()), mS->backgroundColor());
-	drawField(p);
+	// static layer: background & net (only the dirty parts)
+	const QPixmap& field = fieldLayer();
+	qreal dpr = field.devicePixelRatio();
 
-	p.fillRect(mBall.rect(), mS->foregroundColor());
-	p.fillRect(mPlayer1->rect(), mS->foregroundColor());
-	p.fillRect(mPlayer2->rect(), mS->foregroundColor());
+	for (const QRect& r : event->region())
+		p.drawPixmap(r, field, QRectF(r.topLeft()*dpr, r.size()*dpr).toRect());
+
+	QRect objects[DkFrameState::object_end];
+	objectRects(objects);
+
+	for (const QRect& r : objects)
+		p.fillRect(r, mS->foregroundColor());
+
+	// keep track of what is on screen now (parts outside the event's region were not repainted)
+	mShown = mShown.subtracted(event->region());
+	for (const QRect& r : objects)
+		mShown += event->region().intersected(r);
 
 	// clear area under text
 	if (mLargeInfo->isVisible()) {
@@ -604,28 +781,128 @@ void DkPongPort::paintEvent(QPaintEvent* event) {
 	}
 
 	p.end();
+
+	painted(mTick);
+	mFrameStats.addPaint(mClock.nsecsElapsed() - paintStart);
 }
 
-void DkPongPort::drawField(QPainter& p) {
+const QPixmap& DkPongPort::fieldLayer() {
 
-	QPen cPen = p.pen();
-	
-	// set dash pattern
-	QVector<qreal> dashes;
-	dashes << 0.1 << 3;
+	int dpr = viewport()->devicePixelRatio();
+
+	// the layer only changes if the window is resized or the settings are changed
+	if (mFieldLayer.size() != size()*dpr ||
+		mFieldBg != mS->backgroundColor() ||
+		mFieldFg != mS->foregroundColor() ||
+		mFieldUnit != mS->unit()) {
+
+		mFieldBg = mS->backgroundColor();
+		mFieldFg = mS->foregroundColor();
+		mFieldUnit = mS->unit();
 
-	// create style
-	QPen linePen;
-	linePen.setColor(mS->foregroundColor());
-	linePen.setWidth(qRound(mS->unit()*0.5));
-	linePen.setDashPattern(dashes);
-	p.setPen(linePen);
+		// the window is translucent: the layer is composed like the background was before
+		mFieldLayer = QPixmap(size()*dpr);
+		mFieldLayer.setDevicePixelRatio(dpr);
+		mFieldLayer.fill(Qt::transparent);
 
-	// set line
-	QLine line(QPoint(qRound(width()*0.5f), 0), QPoint(qRound(width()*0.5f),height()));
-	p.drawLine(line);
+		QPainter p(&mFieldLayer);
+		p.fillRect(QRect(QPoint(), size()), mFieldBg);
+		DkFrameRenderer::drawField(p, size(), mFieldFg, mFieldUnit);
+	}
+
+	return mFieldLayer;
+}
+
+void DkPongPort::setRenderThread(bool threaded) {
+
+	if (threaded == (mRenderThread != 0))
+		return;
+
+	if (threaded) {
+		mRenderThread = new DkRenderThread(this);
+		connect(mRenderThread, SIGNAL(frameReady()), this, SLOT(takeFrame()), Qt::QueuedConnection);
+		mRenderThread->start();
+	}
+	else {
+		delete mRenderThread;
+		mRenderThread = 0;
+		mFrame = QImage();
+		mFrameState = DkFrameState();
+	}
 
-	p.setPen(cPen);
+	// the render thread draws the texts too
+	mP1Score->setExternalRendering(threaded);
+	mP2Score->setExternalRendering(threaded);
+	mLargeInfo->setExternalRendering(threaded);
+	mSmallInfo->setExternalRendering(threaded);
+
+	mFullUpdate = true;
+	updateDirty();
+}
+
+DkFrameState DkPongPort::frameState() const {
+
+	DkFrameState s;
+	s.size = size();
+	s.devicePixelRatio = viewport()->devicePixelRatio();
+	s.background = mS->backgroundColor();
+	s.foreground = mS->foregroundColor();
+	s.unit = mS->unit();
+	s.tick = mTick;
+	objectRects(s.objects);
+
+	DkScoreLabel* labels[] = {mP1Score, mP2Score, mLargeInfo, mSmallInfo};
+
+	for (DkScoreLabel* l : labels) {
+
+		if (!l->isVisible())
+			continue;
+
+		DkFrameText t;
+		t.text = l->text();
+		t.rect = l->geometry();
+		t.align = l->textAlignment();
+		t.clear = l == mLargeInfo || l == mSmallInfo;
+		s.texts.push_back(t);
+	}
+
+	return s;
+}
+
+void DkPongPort::takeFrame() {
+
+	if (!mRenderThread)
+		return;
+
+	DkFrameState state;
+	QImage frame = mRenderThread->frame(state);
+
+	// e.g. a text changed
+	if (!state.sameLayout(mFrameState))
+		mFullUpdate = true;
+
+	mFrame = frame;
+	mFrameState = state;
+
+	updateRegion(mFrameState.objects);
+}
+
+void DkPongPort::drawFrame(QPaintEvent* event) {
+
+	QPainter p(viewport());
+	qreal dpr = mFrame.devicePixelRatio();
+
+	for (const QRect& r : event->region())
+		p.drawImage(r, mFrame, QRectF(r.topLeft()*dpr, r.size()*dpr).toRect());
+
+	mShown = mShown.subtracted(event->region());
+	for (const QRect& r : mFrameState.objects)
+		mShown += event->region().intersected(r);
+
+	// the labels or the window changed after the frame was requested
+	DkFrameState state = frameState();
+	if (!state.sameLayout(mFrameState))
+		mRenderThread->render(state);
 }
 
 void DkPongPort::startCountDown(int sec) {
@@ -641,12 +918,68 @@ void DkPongPort::startCountDown(int sec) {
 	mLargeInfo->show();
 	mSmallInfo->hide();
 	mHighscores->hide();
+	mLeaderboard->hide();
+
+	mFullUpdate = true;
+	updateDirty();
+}
+
+void DkPongPort::updateLeaderboard() {
+
+	// O(players): the summary is kept up to date by the score writer
+	std::vector<DkPlayerStats> players = mHighscores->ranking(5);
+
+	if (players.empty()) {
+		mLeaderboard->hide();
+		return;
+	}
+
+	QString text = QString("%1 %2 %3 %4 %5 %6")
+		.arg("#", 2)
+		.arg(tr("Player"), -16)
+		.arg(tr("W"), 4)
+		.arg(tr("L"), 4)
+		.arg("+/-", 5)
+		.arg(tr("Streak"), 7);
+
+	for (size_t idx = 0; idx < players.size(); idx++) {
+
+		const DkPlayerStats& s = players[idx];
+		QString streak = s.streak > 0 ? tr("W%1").arg(s.streak) : s.streak < 0 ? tr("L%1").arg(-s.streak) : "-";
+		int diff = s.pointsFor - s.pointsAgainst;
+
+		text += QString("\n%1 %2 %3 %4 %5 %6")
+			.arg((int)idx + 1, 2)
+			.arg(s.name.left(16), -16)
+			.arg(s.wins, 4)
+			.arg(s.losses, 4)
+			.arg((diff > 0 ? "+" : "") + QString::number(diff), 5)
+			.arg(streak, 7);
+	}
+
+	mLeaderboard->setText(text);
+	mLeaderboard->adjustSize();
+
+	// centered below the scores
+	QRect r = mLeaderboard->rect();
+	r.moveCenter(QPoint(width() / 2, 0));
+	r.moveTop(DkFrameRenderer::labelRect(DkFrameRenderer::label_score1, size(), mS->unit()).bottom() + mS->unit());
+	mLeaderboard->move(r.topLeft());
+	mLeaderboard->show();
 }
 
 void DkPongPort::resizeEvent(QResizeEvent *event) {
 
+	// the labels are resized below
+	DkScoreLabel::clearCache();
+	mFieldLayer = QPixmap();
+	mFullUpdate = true;
+
 	//resize(event->size());
 
+	// the recorded inputs belong to the old field
+	mRecorder.discard();
+
 	mS->setField(QRect(QPoint(), event->size()));
 	mPlayerSpeed = qRound(mS->field().width()*0.007);
 	mPlayer1->updateSize();
@@ -655,22 +988,14 @@ void DkPongPort::resizeEvent(QResizeEvent *event) {
 
 	initGame();
 
-	// resize player scores
-	QRect sR(QPoint(0, mS->unit()*3), QSize(qRound(width()*0.5), qRound(height()*0.15)));
-	QRect sR1 = sR;
-	QRect sR2 = sR;
-	sR2.moveLeft(qRound(width()*0.5));
-	mP1Score->setGeometry(sR1);
-	mP2Score->setGeometry(sR2);
-	
-	// resize info labels
-	QRect lIR(QPoint(qRound(width()*0.15),0), QSize(qRound(width()*0.7), qRound(height()*0.15)));
-	lIR.moveBottom(qRound(height()*0.5 + mS->unit()));
-	mLargeInfo->setGeometry(lIR);
-	
-	QRect sIR(QPoint(qRound(width()*0.15),0), QSize(qRound(width()*0.7), qRound(height()*0.08)));
-	sIR.moveTop(qRound(height()*0.5 + mS->unit()*2));
-	mSmallInfo->setGeometry(sIR);
+	// resize player scores & info labels (the layout is shared with pong-render)
+	mP1Score->setGeometry(DkFrameRenderer::labelRect(DkFrameRenderer::label_score1, size(), mS->unit()));
+	mP2Score->setGeometry(DkFrameRenderer::labelRect(DkFrameRenderer::label_score2, size(), mS->unit()));
+	mLargeInfo->setGeometry(DkFrameRenderer::labelRect(DkFrameRenderer::label_large_info, size(), mS->unit()));
+	mSmallInfo->setGeometry(DkFrameRenderer::labelRect(DkFrameRenderer::label_small_info, size(), mS->unit()));
+
+	if (!mLeaderboard->isHidden())
+		updateLeaderboard();
 
 	QWidget::resizeEvent(event);
 	
@@ -678,6 +1003,164 @@ void DkPongPort::resizeEvent(QResizeEvent *event) {
 
 void DkPongPort::gameLoop() {
 
+	qint64 start = mClock.nsecsElapsed();
+
+	// run as many fixed ticks as the monotonic clock demands
+	int steps = mStep.advance(start);
+	int ticks = 0;
+	bool running = true;
+
+	while (running && ticks < steps) {
+		running = tick();
+		ticks++;
+	}
+
+	if (running) {
+		mAlpha = mStep.alpha();
+		updateDirty();
+	}
+	else
+		mAlpha = 1.0;
+
+	mFrameStats.addFrame(start, mClock.nsecsElapsed() - start, ticks);
+}
+
+void DkPongPort::setPerfOverlay(bool show) {
+
+	if (show == perfOverlay())
+		return;
+
+	if (show) {
+		mPerfSamples = mController ? mController->frames() : 0;
+		mPerfNs = mClock.nsecsElapsed();
+		updatePerfOverlay();
+		mPerfOverlay->show();
+		mPerfTimer->start();
+	}
+	else {
+		mPerfTimer->stop();
+		mPerfOverlay->hide();
+	}
+}
+
+bool DkPongPort::perfOverlay() const {
+	return mPerfTimer->isActive();
+}
+
+const DkFrameStats& DkPongPort::frameStats() const {
+	return mFrameStats;
+}
+
+void DkPongPort::updatePerfOverlay() {
+
+	auto timing = [&](const QString& name, DkFrameStats::Timing t) {
+		DkFrameStats::Summary s = mFrameStats.summary(t);
+		return QString("%1 p50 %2  p99 %3  max %4 ms\n")
+			.arg(name, -6)
+			.arg(s.p50, 6, 'f', 2)
+			.arg(s.p99, 6, 'f', 2)
+			.arg(s.max, 6, 'f', 2);
+	};
+
+	// controller samples since the last update
+	qint64 now = mClock.nsecsElapsed();
+	quint64 samples = mController ? mController->frames() : 0;
+	double sampleRate = now > mPerfNs ? (samples - mPerfSamples) * 1e9 / (now - mPerfNs) : 0.0;
+	mPerfSamples = samples;
+	mPerfNs = now;
+
+	QString text;
+	text += QString("%1 %2 /s\n").arg("tick", -6).arg(mFrameStats.tickRate(), 6, 'f', 1);
+	text += timing("loop", DkFrameStats::timing_loop);
+	text += timing("paint", DkFrameStats::timing_paint);
+	text += timing("frame", DkFrameStats::timing_interval);
+	text += QString("%1 %2 /s  resyncs %3")
+		.arg("input", -6)
+		.arg(sampleRate, 6, 'f', 0)
+		.arg(mController ? mController->resyncs() : 0);
+
+	if (mRenderThread)
+		text += QString("\n%1 %2 frames  %3 skipped")
+			.arg("render", -6)
+			.arg(mRenderThread->renderedFrames())
+			.arg(mRenderThread->skippedFrames());
+
+	if (const DkScoreWriter* w = mHighscores->scoreWriter())
+		text += QString("\n%1 %2 queued  commit p99 %3 ms")
+			.arg("db", -6)
+			.arg(w->queueDepth())
+			.arg(w->commitLatency().percentile(0.99) / 1000.0, 0, 'f', 1);
+
+	mPerfOverlay->setText(text);
+	mPerfOverlay->adjustSize();
+	mPerfOverlay->move(mS->unit(), mS->unit());
+}
+
+void DkPongPort::objectRects(QRect* rects) const {
+
+	// all objects are interpolated to the same time - a filtered paddle's lead is simulated (see DkEnginePlayer::move)
+	rects[DkFrameState::object_ball] = interpolate(mPrevBall, mBall.rect());
+	rects[DkFrameState::object_player1] = interpolate(mPrevPlayer1, mPlayer1->rect());
+	rects[DkFrameState::object_player2] = interpolate(mPrevPlayer2, mPlayer2->rect());
+}
+
+void DkPongPort::updateDirty() {
+
+	// the frame is presented once it is rendered (see takeFrame)
+	if (mRenderThread) {
+		mRenderThread->render(frameState());
+		return;
+	}
+
+	QRect objects[DkFrameState::object_end];
+	objectRects(objects);
+	updateRegion(objects);
+}
+
+void DkPongPort::updateRegion(const QRect* objects) {
+
+	// e.g. the overlay changed
+	if (mFullUpdate) {
+		mFullUpdate = false;
+		viewport()->update();
+		return;
+	}
+
+	// only the ball & players move: repaint where they were & where they are now
+	QRegion dirty = mShown;
+	for (int idx = 0; idx < DkFrameState::object_end; idx++)
+		dirty += objects[idx];
+
+	viewport()->update(dirty);
+}
+
+bool DkPongPort::tick() {
+
+	// paddles that move from now on are shown by this tick's frames
+	mTick++;
+
+	// only the newest controller values are used (once per tick)
+	takeControllerValues();
+
+	// the pause pin might have stopped us
+	if (!mEventLoop->isActive())
+		return false;
+
+	// inputs that came in so far belong to this tick
+	mRecorder.endTick();
+
+	if (mReplay.isOpen() && !mReplay.apply(mPlayer1, mPlayer2, &mBall)) {
+		pauseGame();
+		mLargeInfo->setText(tr("Replay finished"));
+		mSmallInfo->setText(tr("Hit <SPACE> to watch it again"));
+		mPlayer1->resetScore();
+		mPlayer2->resetScore();
+		mNewMatch = true;
+		return false;
+	}
+
+	keepState();
+
 	// logic first
 	if (!mBall.move(mPlayer1, mPlayer2)) {
 
@@ -688,36 +1171,62 @@ void DkPongPort::gameLoop() {
 			pauseGame();
 			mLargeInfo->setText(tr("%1 won!").arg(mPlayer1->score() > mPlayer2->score() ? mPlayer1->name() : mPlayer2->name()));
 			mSmallInfo->setText(tr("Hit <SPACE> to start a new Game"));
-			mHighscores->commitScore(mPlayer1->score(), mPlayer2->score());
+
+			// the replay is written in the thread pool
+			if (mRecorder.isRecording())
+				mReplayWrites.addFuture(QtConcurrent::run(&DkReplayWriter::write, replayPath(), mRecorder.finish(mPlayer1->score(), mPlayer2->score())));
+
+			if (!mReplay.isOpen()) {
+				mHighscores->commitScore(mPlayer1->score(), mPlayer2->score());
+				updateLeaderboard();
+			}
 		}
 		else
 			startCountDown();
 
-		return;
+		return false;
 	}
 
 	mPlayer1->move();
 	mPlayer2->move();
 
-	//repaint();
-	viewport()->update();
-	
-	//QGraphicsView::update();
+	// unfiltered paddles were simulated when their values were taken
+	simulated(0);
+	simulated(1);
+
+	return true;
+}
+
+void DkPongPort::keepState() {
+
+	mPrevBall = mBall.rect();
+	mPrevPlayer1 = mPlayer1->rect();
+	mPrevPlayer2 = mPlayer2->rect();
+}
+
+QRect DkPongPort::interpolate(const QRect& prev, const QRect& cur) const {
+
+	if (mAlpha >= 1.0 || prev.size() != cur.size())
+		return cur;
+
+	QPointF tl = prev.topLeft() + QPointF(cur.topLeft() - prev.topLeft()) * mAlpha;
+
+	return QRect(tl.toPoint(), cur.size());
 }
 
 void DkPongPort::keyPressEvent(QKeyEvent *event) {
 
 	if (event->key() == Qt::Key_Up && !event->isAutoRepeat()) {
-		mPlayer2->setSpeed(-mPlayerSpeed);
+		setPlayerSpeed(mPlayer2, -mPlayerSpeed);
 	}
 	if (event->key() == Qt::Key_Down && !event->isAutoRepeat()) {
-		mPlayer2->setSpeed(mPlayerSpeed);
+		setPlayerSpeed(mPlayer2, mPlayerSpeed);
 	}
 	if (event->key() == Qt::Key_W && !event->isAutoRepeat()) {
-		mPlayer1->setSpeed(-mPlayerSpeed);
+		setPlayerSpeed(mPlayer1, -mPlayerSpeed);
 	}
 	if (event->key() == Qt::Key_S && !event->isAutoRepeat()) {
-		mPlayer1->setSpeed(mPlayerSpeed);
+		setPlayerSpeed(mPlayer1, mPlayerSpeed);
 	}
 	if (event->key() == Qt::Key_Space) {
 		
@@ -744,6 +1253,9 @@ void DkPongPort::keyPressEvent(QKeyEvent *event) {
 	if (event->key() == Qt::Key_D) {
 		mHighscores->changePlayer(Screen::Player1, 0.8);
 	}
+	if (event->key() == Qt::Key_F3) {
+		setPerfOverlay(!perfOverlay());
+	}
 
 	QWidget::keyPressEvent(event);
 }
@@ -751,228 +1263,35 @@ void DkPongPort::keyPressEvent(QKeyEvent *event) {
 void DkPongPort::keyReleaseEvent(QKeyEvent* event) {
 
 	if ((event->key() == Qt::Key_Up && !event->isAutoRepeat()) || (event->key() == Qt::Key_Down && !event->isAutoRepeat())) {
-		mPlayer2->setSpeed(0);
+		setPlayerSpeed(mPlayer2, 0);
 	}
 	if ((event->key() == Qt::Key_W && !event->isAutoRepeat()) || (event->key() == Qt::Key_S && !event->isAutoRepeat())) {
-		mPlayer1->setSpeed(0);
+		setPlayerSpeed(mPlayer1, 0);
 	}
 
 	QWidget::keyReleaseEvent(event);
 }
 
 // DkBall --------------------------------------------------------------------
-DkBall::DkBall(QSharedPointer<DkPongSettings> settings) {
+DkBall::DkBall(QSharedPointer<DkPongSettings> settings) : DkEngineBall(settings) {
 
-	qsrand(QTime::currentTime().msec());
-	mS = settings;
-	
-	mMinSpeed = qRound(mS->field().width()*0.005);
-	mMaxSpeed = qRound(mS->field().width()*0.01);
 	qDebug() << "maxSpeed: " << mMaxSpeed;
-
-	mRect = QRect(QPoint(), QSize(mS->unit(), mS->unit()));
-
-	//setDirection(DkVector(10, 10));
-
-	reset();
-}
-
-void DkBall::reset() {
-	
-	qDebug() << "speed: " << mS->speed();
-
-	//mDirection = DkVector(3, 0);// DkVector(mUnit*0.15f, mUnit*0.15f);
-	mRect.moveCenter(QPoint(qRound(mS->field().width()*0.5f), qRound(mS->field().height()*0.5f)));
-	mRally = 0;
-	setSpeed(mS->speed());
-}
-
-void DkBall::updateSize() {
-	mMinSpeed = qRound(mS->field().width()*0.005);
-	mMaxSpeed = qRound(mS->field().width()*0.02);
-	setDirection(DkVector((float)qrand()/RAND_MAX*10.0f-5.0f, (float)qrand()/RAND_MAX*5.0f-2.5f));
-	//setDirection(DkVector(10,10));
-}
-
-QRect DkBall::rect() const {
-	return mRect;
-}
-
-QPoint DkBall::direction() const {
-	return mDirection.toQPointF().toPoint();
-}
-
-void DkBall::setSpeed(float val) {
-	mSpeed = val;
-	mS->setSpeed(mSpeed);	// update settings speed
-
-	if (mSpeed < mMinSpeed)
-		mSpeed = (float)mMinSpeed;
-	if (mSpeed > mMaxSpeed)
-		mSpeed = (float)mMaxSpeed;
-
-	qDebug() << "speed" << mSpeed;
-}
-
-float DkBall::speed() const {
-	return mSpeed;
-}
-
-void DkBall::setAnalogueSpeed(float val) {
-
-	setSpeed(val * (mMaxSpeed - mMinSpeed) + mMinSpeed);
 }
 
 bool DkBall::move(DkPongPlayer* player1, DkPongPlayer* player2) {
 
-	// check minimum speed 
-	if (mSpeed < mMinSpeed)
-		mSpeed = (float)mMinSpeed;
-
-	DkVector dir = mDirection;
-	dir.normalize();
-	dir *= mSpeed;//	 (float)(mSpeed + qRound(mRally / 10.0));
-	fixDirection(dir);
+	// the physics lives in the engine - we just add the sound
+	bool running = DkEngineBall::move(player1, player2);
 
-	// collision detection top & bottom
-	if (mRect.top() <= mS->field().top() && dir.y < 0 || mRect.bottom() >= mS->field().bottom() && dir.y > 0) {
-		dir.rotate(dir.angle()*2);
-		//qDebug() << "collision...";
-	}
-
-	DkVector nextCenter = mRect.center() + dir.toQPointF().toPoint();
-
-	// player collision
-	if (dir.x < 0 && collision(player1->rect(), nextCenter)) {
-		mSpeed *= changeDirPlayer(player1, dir);
-		nextCenter = DkVector(mRect.center()) + dir;
+	if (lastHit() == player1)
 		player1->sound();
-		mRally++;
-		qDebug() << "rally speed: " << qRound(mRally/10.0);
-	}
-	else if (dir.x > 0 && collision(player2->rect(), nextCenter)) {
-		mSpeed *= changeDirPlayer(player2, dir);
-		nextCenter = DkVector(mRect.center()) + dir;
+	else if (lastHit() == player2)
 		player2->sound();
-		mRally++;
-		qDebug() << "rally speed: " << qRound(mRally/10.0);
-	}
-	// collision detection left & right
-	else if (mRect.left() <= mS->field().left()) {
-		dir = QPointF(player2->rect().center())-mS->field().center();
-		dir.normalize();
-		dir *= (float)mMinSpeed;
-		setDirection(dir);
-		player2->increaseScore();
-		return false;
-	}
-	else if (mRect.right() >= mS->field().right()) {
-		dir = QPointF(player1->rect().center())-mS->field().center();
-		dir.normalize();
-		dir *= (float)mMinSpeed;
-		setDirection(dir);
-		player1->increaseScore();
-		return false;
-	}
-
-	//qDebug() << ballDir.angle();
-
-	setDirection(dir);
-	mRect.moveCenter(nextCenter.toQPointF().toPoint());
-	
-	return true;
-}
-
-float DkBall::changeDirPlayer(const DkPongPlayer* player, DkVector& dir) const {
-
-	float newSpeed = 1.0f;
-
-	// if the player moves in the ball direction speed it up
-	if (player->velocity()*dir.y > 0)
-		newSpeed -= 0.2f;
-	else if (player->velocity()*dir.y < 0)
-		newSpeed += 0.2f;
-
-	if (newSpeed != 1)
-		qDebug() << "speed changed: " << newSpeed;
-
-	double nAngle = dir.angle() + DK_PI*0.5;
-	double magic = (double)qrand() / RAND_MAX * 0.5 - 0.25;
-
-	dir.rotate((nAngle * 2)+magic);
-
-	// change the angle if the ball becomes horizontal
-	if (DkMath::distAngle(DkMath::normAngleRad(dir.angle(), 0.0, DK_PI), 0.0) > 0.01)
-		dir.rotate(0.6);
-	//	qDebug() << "0 angle: " << dir.angle();
-	//else
-	//	qDebug() << "angle: " << dir.angle();
-		//dir.rotate(0.7);
-
-	fixDirection(dir);
-
-	return newSpeed;
-}
-
-bool DkBall::collision(const QRect& player, const DkVector& nextCenter) const {
-
-	if (player.intersects(mRect))
-		return true;
-
-	// first check if we cross the player line
-	float pc = (float)player.center().x();
-	float cx = (float)mRect.center().x();
-
-	if ((cx - pc)  * (nextCenter.x - pc) > 0)
-		return false;
-	
-	if (qMin((float)mRect.center().y(), nextCenter.y) < player.top() || 
-		qMax((float)mRect.center().y(), nextCenter.y) > player.bottom())
-		return false;
-
-	return true;
-}
-
-void DkBall::setDirection(const DkVector& dir) {
-
-	mDirection = dir;
-	fixDirection(mDirection);
-}
-
-void DkBall::fixDirection(DkVector& dir) const {
-	
-	// check angle
-	fixAngle(dir);
-
-	if (dir.norm() > mMaxSpeed) {
-		dir.normalize();
-		dir *= (float)mMaxSpeed;
-	}
-	else if (mDirection.norm() < mMinSpeed) {
-		dir.normalize();
-		dir *= (float)mMinSpeed;
-	}
-}
-
-void DkBall::fixAngle(DkVector& dir) const {
 
-	double angle = dir.angle();
-	double range = DK_PI / 5.0;
-	double sign = angle > 0 ? 1.0 : -1.0;
-	angle = abs(angle);
-	double newAngle = 0.0;
-
-	if (angle < DK_PI*0.5 && angle > DK_PI*0.5 - range) {
-		newAngle = DK_PI*0.5 - range;
-	}
-	else if (angle > DK_PI*0.5 && angle < DK_PI*0.5 + range) {
-		newAngle = DK_PI*0.5 + range;
-	}
+	if (lastHit())
+		qDebug() << "rally speed: " << qRound(mRally/10.0);
 
-	if (newAngle != 0.0) {
-		dir.rotate(mDirection.angle() - (newAngle*sign));
-		//qDebug() << "angle: " << angle << " new angle: " << newAngle;
-	}
+	return running;
 }
 
 // DkBall --------------------------------------------------------------------
@@ -1011,7 +1330,15 @@ void DkPong::keyPressEvent(QKeyEvent *event) {
 
 void DkPong::closeEvent(QCloseEvent * event) {
 
-	mViewport->settings()->writeSettings();
+	mViewport->writeLatency();
+
+	// the last scores must not get lost
+	if (!mViewport->highscores()->flushScores())
+		qWarning() << "not all scores could be written to the database";
+
+	// replays change the settings temporarily
+	if (!mViewport->isReplaying())
+		mViewport->settings()->writeSettings();
 
 	QMainWindow::closeEvent(event);
 }
@@ -1024,65 +1351,148 @@ DkPlayers::DkPlayers(DkHighscores* highscores, Qt::Alignment align)
 		mSelected(0), 
 		mAlign(align)
 {
-	//setLayout(mLayout);
+	setFixedHeight(selectedSize() + 20);
 }
 
 void DkPlayers::create()
 {
+	ensureVisible(mSelected);
+	update();
+}
 
-	QWidget* dummy = new QWidget(this);
-	mLayout = new QHBoxLayout(dummy);
-	mLayout->setAlignment(mAlign);
-	mLayout->setMargin(0);
-	
-	auto addPlayer = [this](QSharedPointer<Player> player) {
-		QLabel* label = new QLabel(this);
-		mLayout->addWidget(label);
-		mLabels.push_back(label);
-	};
+int DkPlayers::selectedSize() {
+	return 142;
+}
 
-	std::for_each(mHighscores->players().begin(), mHighscores->players().end(), addPlayer);
-	setSelected(mSelected);
+int DkPlayers::size() {
+	return 100;
+}
 
-	mScrollArea = new QScrollArea(this);
-	mScrollArea->setAlignment(mAlign);
-	mScrollArea->setObjectName("playerSelection");
-	mScrollArea->setFixedHeight(selectedSize() + 20);
-	mScrollArea->setWidget(dummy);
-	mScrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-	mScrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+int DkPlayers::pitch() {
+	// the selected picture just fills the gaps to its neighbours
+	return size() + (selectedSize() - size()) / 2;
+}
 
-	QHBoxLayout* l = new QHBoxLayout(this);
-	l->setAlignment(mAlign);
-	l->setContentsMargins(20, 0, 20, 0);
-	l->addWidget(mScrollArea);
+int DkPlayers::margin() {
+	return 20;
+}
 
+QRect DkPlayers::viewRect() const
+{
+	return rect().adjusted(margin(), 0, -margin(), 0);
 }
 
-int DkPlayers::selectedSize() {
-	return 142;
+QRect DkPlayers::slotRect(int idx) const
+{
+	return QRect(viewRect().left() + idx*pitch() - mOffset, 0, pitch(), height());
 }
 
-int DkPlayers::size() {
-	return 100;
+bool DkPlayers::ensureVisible(int idx)
+{
+	int viewWidth = viewRect().width();
+	int contentWidth = (int)mHighscores->players().size() * pitch();
+	int offset = mOffset;
+
+	// everything fits: align the pictures
+	if (contentWidth <= viewWidth)
+		offset = mAlign & Qt::AlignRight ? contentWidth - viewWidth : 0;
+	else {
+		// scroll as little as possible (like QScrollArea::ensureWidgetVisible)
+		int left = idx*pitch();
+		int right = left + pitch();
+		int m = qMin(50, (viewWidth - pitch()) / 2);
+
+		if (left - m < offset)
+			offset = left - m;
+		else if (right + m > offset + viewWidth)
+			offset = right + m - viewWidth;
+
+		offset = qBound(0, offset, contentWidth - viewWidth);
+	}
+
+	if (offset == mOffset)
+		return false;
+
+	mOffset = offset;
+	return true;
 }
 
 void DkPlayers::setSelected(int idx)
 {
-	for (size_t i = 0; i < mLabels.size(); ++i) {
-		if (idx == i) {
-			mLabels[i]->setPixmap(mHighscores->players()[i]->pictureSelected);
-			
-			if (mScrollArea)
-				mScrollArea->ensureWidgetVisible(mLabels[i]);
-		}
-		else {
-			mLabels[i]->setPixmap(mHighscores->players()[i]->picture);
-		}
-	}
+	if (idx == mSelected)
+		return;
 
+	int old = mSelected;
 	mSelected = idx;
-	update();
+
+	// all slots moved
+	if (ensureVisible(idx))
+		update();
+	else {
+		// the selected picture is wider than its slot
+		int overlap = (selectedSize() - pitch()) / 2 + 1;
+		update(slotRect(old).adjusted(-overlap, 0, overlap, 0));
+		update(slotRect(idx).adjusted(-overlap, 0, overlap, 0));
+	}
+}
+
+void DkPlayers::updatePlayer(int idx)
+{
+	if (idx < 0 || idx >= (int)mHighscores->players().size())
+		return;
+
+	int overlap = (selectedSize() - pitch()) / 2 + 1;
+	QRect r = slotRect(idx).adjusted(-overlap, 0, overlap, 0);
+
+	if (r.intersects(viewRect()))
+		update(r);
+}
+
+void DkPlayers::resizeEvent(QResizeEvent* event)
+{
+	ensureVisible(mSelected);
+	QWidget::resizeEvent(event);
+}
+
+void DkPlayers::paintEvent(QPaintEvent* event)
+{
+	const std::vector<QSharedPointer<Player>>& players = mHighscores->players();
+
+	if (players.empty())
+		return;
+
+	QRect dirty = event->rect().intersected(viewRect());
+
+	if (dirty.isEmpty())
+		return;
+
+	// only the slots in the dirty rect (and their neighbours - the selected picture overlaps them) are painted
+	int first = qMax((dirty.left() - viewRect().left() + mOffset) / pitch() - 1, 0);
+	int last = qMin((dirty.right() - viewRect().left() + mOffset) / pitch() + 1, (int)players.size()-1);
+
+	QPainter p(this);
+	p.setClipRect(dirty);
+
+	auto draw = [&](int idx) {
+
+		const QPixmap& pm = idx == mSelected ? players[idx]->pictureSelected : players[idx]->picture;
+
+		if (pm.isNull())
+			return;
+
+		QRect r(QPoint(), pm.size() / pm.devicePixelRatio());
+		r.moveCenter(slotRect(idx).center());
+		p.drawPixmap(r, pm);
+	};
+
+	for (int idx = first; idx <= last; idx++) {
+		if (idx != mSelected)
+			draw(idx);
+	}
+
+	// on top of its neighbours
+	if (mSelected >= first && mSelected <= last)
+		draw(mSelected);
 }
 
 int DkPlayers::selected() const
@@ -1118,14 +1528,19 @@ void DkHighscores::changePlayer(Screen screen, double player)
 	double cnt = (double)players().size();
 	int idx = (int)floor(player*cnt);
 
-	qDebug() << "new player index: " << idx << "normed:" << player;
-
 	if (idx < 0 || idx >= players().size()) {
 		qDebug() << "player selection out of bounds";
 		return;
 	}
 
-	
+	// the selection pins stream values - most of them do not change the player
+	int& last = mChangedIdx[screen == Screen::Player1 ? 0 : 1];
+	if (idx == last)
+		return;
+	last = idx;
+
+	qDebug() << "new player index: " << idx << "normed:" << player;
+
 	switch (screen) {
 	case Screen::Player1: mLeft->setSelected(idx); break;
 	case Screen::Player2: mRight->setSelected(idx); break;
@@ -1164,37 +1579,110 @@ void DkHighscores::loadDB(const QString& name)
 	}
 
 	qDebug() << dbInfo.absoluteFilePath() << "is opened...";
+
+	// the leaderboard summary is created from the history once
+	if (DkLeaderboard::createTable(mDB))
+		DkLeaderboard::rebuild(mDB);
+
+	DkLeaderboard leaderboard;
+	leaderboard.load(mDB);
+
+	// scores are written by a worker thread (with its own connection)
+	mWriter = new DkScoreWriter(dbInfo.absoluteFilePath(), this);
+	mWriter->setLeaderboard(leaderboard);
+	mWriter->start();
 	
 	QSqlQuery query = QSqlQuery(mDB);
+	query.setForwardOnly(true);
+
 	// Get image data back from database
 	if (!query.exec("SELECT name, picture from players"))
 		qDebug() << "Error getting image from table:\n" << query.lastError();
 
+	// shown until the pictures are decoded
+	QPixmap placeholder(DkPlayers::size(), DkPlayers::size());
+	placeholder.fill(QColor(255, 255, 255, 40));
+	QPixmap placeholderSelected(DkPlayers::selectedSize(), DkPlayers::selectedSize());
+	placeholderSelected.fill(QColor(255, 255, 255, 80));
 
 	while (query.next()) {
 		QString playerName = query.value(0).toString();
 		QByteArray outByteArray = query.value(1).toByteArray();
-		
-		QPixmap picture;
-		picture.loadFromData(outByteArray);
-		picture = picture.scaledToWidth(DkPlayers::size());
-
-		QPixmap selected;
-		selected.loadFromData(outByteArray);
-		selected = selected.scaledToWidth(DkPlayers::selectedSize());
 
 		QSharedPointer<Player> player(new Player());
 		player->name = playerName;
-		player->picture = picture;
-		player->pictureSelected = selected;
+		player->picture = placeholder;
+		player->pictureSelected = placeholderSelected;
 		mPlayers.push_back(player);
+
+		// decode & scale in the thread pool while the next rows are fetched
+		int idx = (int)mPlayers.size()-1;
+		QFutureWatcher<PlayerPictures>* watcher = new QFutureWatcher<PlayerPictures>(this);
+		connect(watcher, &QFutureWatcher<PlayerPictures>::finished, this, [this, watcher, idx]() {
+			setPictures(idx, watcher->result());
+			watcher->deleteLater();
+		});
+
+		QFuture<PlayerPictures> future = QtConcurrent::run(&DkHighscores::decodePictures, &mThumbnails, outByteArray);
+		watcher->setFuture(future);
+		mDecoding.addFuture(future);
+		mDecodingLeft++;
 	}
+
+	if (mDecodingLeft == 0)
+		mThumbnails.removeUnused();
+}
+
+PlayerPictures DkHighscores::decodePictures(DkThumbnailCache* cache, const QByteArray& data)
+{
+	// the scaled pictures are cached - decoding is only needed if a picture changed
+	QString key = DkThumbnailCache::key(data);
+
+	PlayerPictures p;
+	p.picture = cache->load(key, DkPlayers::size());
+	p.pictureSelected = cache->load(key, DkPlayers::selectedSize());
+
+	if (!p.picture.isNull() && !p.pictureSelected.isNull())
+		return p;
+
+	QImage img;
+	img.loadFromData(data);
+
+	if (img.isNull())
+		return PlayerPictures();
+
+	p.picture = img.scaledToWidth(DkPlayers::size());
+	p.pictureSelected = img.scaledToWidth(DkPlayers::selectedSize());
+	cache->save(key, DkPlayers::size(), p.picture);
+	cache->save(key, DkPlayers::selectedSize(), p.pictureSelected);
+
+	return p;
+}
+
+void DkHighscores::setPictures(int idx, const PlayerPictures& pictures)
+{
+	// pixmaps can only be created in the GUI thread
+	if (!pictures.picture.isNull()) {
+		mPlayers[idx]->picture = QPixmap::fromImage(pictures.picture);
+		mPlayers[idx]->pictureSelected = QPixmap::fromImage(pictures.pictureSelected);
+	}
+	else {
+		mPlayers[idx]->picture = QPixmap();
+		mPlayers[idx]->pictureSelected = QPixmap();
+	}
+
+	mLeft->updatePlayer(idx);
+	mRight->updatePlayer(idx);
+
+	// thumbnails of changed or deleted pictures
+	if (--mDecodingLeft == 0)
+		mThumbnails.removeUnused();
 }
 
 void DkHighscores::commitScore(int player1, int player2)
 {
 
-	if (!mDB.isOpen()) {
+	if (!mDB.isOpen() || !mWriter) {
 		qDebug() << "database could not be found...";
 		return;
 	}
@@ -1208,17 +1696,38 @@ void DkHighscores::commitScore(int player1, int player2)
 	if (player2 > player1) {
 		swap(winner, looser);
 	}
-	QSqlQuery query(mDB);
-	query.prepare("Insert into scores(winner_name, looser_name, winner_points, looser_points) "
-				  " VALUES (:winner, :looser, :winner_score, :looser_score)"); 
-	query.bindValue(":winner", winner);
-	query.bindValue(":looser", looser);
-	query.bindValue(":winner_score", std::max(player1, player2));
-	query.bindValue(":looser_score", std::min(player1, player2));
-
-	if (!query.exec()) {
-		qDebug() << "Error inserting score in table:\n" << query.lastError();
-	}
+
+	// the insert (and its fsync) must not block the GUI
+	DkScoreRecord score;
+	score.winner = winner;
+	score.looser = looser;
+	score.winnerPoints = std::max(player1, player2);
+	score.looserPoints = std::min(player1, player2);
+	mWriter->add(score);
+}
+
+bool DkHighscores::flushScores(int timeoutMs)
+{
+	if (!mWriter)
+		return true;
+
+	bool flushed = mWriter->flush(timeoutMs);
+	qInfo().noquote() << mWriter->summary();
+
+	return flushed;
+}
+
+const DkScoreWriter* DkHighscores::scoreWriter() const
+{
+	return mWriter;
+}
+
+std::vector<DkPlayerStats> DkHighscores::ranking(int maxPlayers) const
+{
+	if (!mWriter)
+		return std::vector<DkPlayerStats>();
+
+	return mWriter->ranking(maxPlayers);
 }
 }
 
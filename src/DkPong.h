@@ -35,10 +35,22 @@
 #include <map>
 #include <QSqlDatabase>
 #include <QHBoxLayout>
+#include <QElapsedTimer>
+#include <QRegion>
+#include <QCache>
+#include <QFutureSynchronizer>
 
 #pragma warning(pop)		// no warnings from includes - end
 
 #include "DkMath.h"
+#include "engine/DkPongEngine.h"
+#include "engine/DkFixedStep.h"
+#include "engine/DkReplay.h"
+#include "engine/DkLatency.h"
+#include "engine/DkFrameStats.h"
+#include "render/DkRenderer.h"
+#include "DkThumbnailCache.h"
+#include "DkLeaderboard.h"
 #pragma warning(disable: 4251)
 
 #ifndef DllExport
@@ -56,27 +68,20 @@ class QSound;
 namespace pong {
 
 class DkArduinoController;
+class DkRenderThread;
+class DkScoreWriter;
 
-class DllExport DkPongSettings {
+class DllExport DkPongSettings : public DkEngineSettings {
 
 public:
 	DkPongSettings();
 
-	void setField(const QRect& field);
-	QRect field() const;
-
-	void setUnit(int unit);
-	int unit() const;
-
 	void setBackgroundColor(const QColor& col);
 	QColor backgroundColor() const;
 
 	void setForegroundColor(const QColor& col);
 	QColor foregroundColor() const;
 
-	void setTotalScore(int maxScore);
-	int totalScore() const;
-
 	void writeSettings();
 
 	void setPlayer1Name(const QString& name);
@@ -92,25 +97,15 @@ public:
 	int player1SelectPin() const;
 	int player2SelectPin() const;
 
-	float playerRatio() const;
-
-	void setSpeed(float speed);
-	float speed() const;
-
 	QString DBPath() const;
 
 protected:
-	QRect mField;
-	int mUnit = 10;
-	int mTotalScore = 10;
-
 	int mPlayer1Pin = 2;
 	int mPlayer2Pin = 4;
 	int mSpeedPin = 1;
 	int mPausePin = 7;
 	int mPlayer1SelectPin = 3;
 	int mPlayer2SelectPin = 4;
-	float mSpeed = 30.0f;
 
 	QColor mBgCol = QColor(0,0,0,100);
 	QColor mFgCol = QColor(255,255,255);
@@ -118,93 +113,34 @@ protected:
 	QString mPlayer1Name = QObject::tr("Player 1");
 	QString mPlayer2Name = QObject::tr("Player 2");
 
-	float mPlayerRatio = 0.15f;
-
 	QString mDBName;
 
 	void loadSettings();
 };
 
-class DllExport DkPongPlayer : public QObject {
+class DllExport DkPongPlayer : public QObject, public DkEnginePlayer {
 	Q_OBJECT
 
 public:
 	DkPongPlayer(const QString& playerName = QObject::tr("Anonymous"), const QString& soundFile = ":/pong/audio/player1-collision.wav", QSharedPointer<DkPongSettings> settings = QSharedPointer<DkPongSettings>(new DkPongSettings()), QObject* parent = 0);
 
-	void reset(const QPoint& pos);
-	QRect rect() const;
-	int pos() const;
-	void setHeight(int newHeight);
-
-	void move();
-	void setSpeed(int speed);
-
-	void updateSize();
-	void increaseScore();
-
-	void resetScore();
-	int score() const;
-
 	void setName(const QString& name);
 	QString name() const;
 
-	void setPos(float pos);
-
 	void sound() const;
 
-	int velocity() const;
-
-signals:
-	void updatePaint() const;
-
 protected:
-	int mSpeed = 0;
-	int mVelocity = 0;
-
-	int mScore = 0;
-	int mPos = INT_MAX;
-	float mControllerPos = -1.0f;
 	QSound* mSound = 0;
 
-	QSharedPointer<DkPongSettings> mS;
-	QRect mRect;
-
 	QString mPlayerName;
 };
 
-class DllExport DkBall {
+class DllExport DkBall : public DkEngineBall {
 
 public:
 	DkBall(QSharedPointer<DkPongSettings> settings = QSharedPointer<DkPongSettings>(new DkPongSettings()));
 
-	void reset();
-	void updateSize();
-
-	QRect rect() const;
-	QPoint direction() const;
-
-	void setSpeed(float val);
-	float speed() const;
-
-	void setAnalogueSpeed(float val);
 	bool move(DkPongPlayer* player1, DkPongPlayer* player2);
-
-protected:
-	int mMinSpeed = 5;
-	int mMaxSpeed = 50;
-	float mSpeed = 3.0f;
-
-	DkVector mDirection;
-	QRect mRect;
-	int mRally = 0;
-
-	QSharedPointer<DkPongSettings> mS;
-
-	void fixAngle(DkVector& dir) const;
-	void fixDirection(DkVector& dir) const;
-	void setDirection(const DkVector& dir);
-	bool collision(const QRect& player, const DkVector& nextCenter) const;
-	float changeDirPlayer(const DkPongPlayer* layer, DkVector& dir) const;
 };
 
 class DllExport DkScoreLabel : public QLabel {
@@ -213,10 +149,27 @@ class DllExport DkScoreLabel : public QLabel {
 public:
 	DkScoreLabel(Qt::Alignment align = Qt::AlignLeft, QWidget* parent = 0, QSharedPointer<DkPongSettings> settings = QSharedPointer<DkPongSettings>(new DkPongSettings()));
 
+	/**
+	 * Drops all rendered texts of all labels.
+	 * Texts are cached per (text, size, colour & unit),
+	 * so this only frees memory that is not needed anymore.
+	 **/
+	static void clearCache();
+
+	/**
+	 * The label does not paint if its text is rendered elsewhere (see DkRenderThread).
+	 * It still holds the text & geometry.
+	 **/
+	void setExternalRendering(bool external);
+	Qt::Alignment textAlignment() const;
+
 protected:
 	void paintEvent(QPaintEvent* ev);
+	static QCache<QString, QPixmap>& cache();
+
 	QFont mFont;
 	Qt::Alignment mAlign;
+	bool mExternal = false;
 
 	QSharedPointer<DkPongSettings> mS;
 };
@@ -230,9 +183,18 @@ struct Player {
 	QPixmap pictureSelected;
 	QString name;
 };
+struct PlayerPictures {
+	QImage picture;
+	QImage pictureSelected;
+};
 
 class DkHighscores;
 
+/**
+ * Carousel of the players' pictures.
+ * It has no child widgets: only the visible slots are painted and
+ * a selection change repaints the old & new slot (unless it scrolls).
+ **/
 class DllExport DkPlayers : public QWidget {
 	Q_OBJECT
 
@@ -241,16 +203,25 @@ public:
 	int selected() const;
 	void setSelected(int idx);
 	void create();
+	void updatePlayer(int idx);
 	static int selectedSize();
 	static int size();
 
+protected:
+	void paintEvent(QPaintEvent* event) override;
+	void resizeEvent(QResizeEvent* event) override;
+
+	static int pitch();
+	static int margin();
+	QRect slotRect(int idx) const;
+	QRect viewRect() const;
+	bool ensureVisible(int idx);
+
 private:
 	DkHighscores *mHighscores;
 	int mSelected;
 	Qt::Alignment mAlign;
-	QHBoxLayout * mLayout;
-	std::vector<QLabel*> mLabels;
-	QScrollArea* mScrollArea = 0;
+	int mOffset = 0;	// scroll position (in pixel)
 };
 
 class DllExport DkHighscores : public QWidget {
@@ -271,17 +242,42 @@ public:
 	void changePlayer(Screen screen, double player);
 	
 	/*!
-		@brief Insert score into DB
+		@brief Insert score into DB (asynchronously, see DkScoreWriter)
 		@param player1 - score for player1
 		@param player2 - score for player2
 	*/
 	void commitScore(int player1, int player2);
 
+	/*!
+		@brief Waits until all scores are written to the DB
+		@param timeoutMs - maximal time to wait
+		@return true if all scores were written
+	*/
+	bool flushScores(int timeoutMs = 5000);
+
+	/*!
+		@brief Returns the DB writer (0 if the DB is not available)
+	*/
+	const DkScoreWriter* scoreWriter() const;
+
+	/*!
+		@brief Returns the best players (from the in-memory leaderboard)
+		@param maxPlayers - number of players (0: all)
+	*/
+	std::vector<DkPlayerStats> ranking(int maxPlayers = 0) const;
+
 	/*!
 		@brief Returns the name of the selected player for the given screen
 	*/
 	QString playerName(Screen screen) const;
 
+	/*!
+		@brief Decodes & scales a player's picture (runs in the thread pool)
+		@param cache - the thumbnail cache
+		@param data - the encoded picture
+	*/
+	static PlayerPictures decodePictures(DkThumbnailCache* cache, const QByteArray& data);
+
 signals:
 	/*!
 		@brief Signal emitted when a new player is selected
@@ -290,8 +286,15 @@ signals:
 private:
 	std::vector<QSharedPointer<Player>> mPlayers;
 	QSqlDatabase mDB;
+	DkScoreWriter* mWriter = 0;
+	DkThumbnailCache mThumbnails;
+	QFutureSynchronizer<PlayerPictures> mDecoding;	// waits for the pool when we are deleted
+	int mDecodingLeft = 0;
 	DkPlayers* mLeft;
 	DkPlayers* mRight;
+	int mChangedIdx[2] = {-1, -1};	// the last player that was announced per screen
+
+	void setPictures(int idx, const PlayerPictures& pictures);
 };
 
 class DllExport DkPongPort : public QGraphicsView {
@@ -304,15 +307,65 @@ public:
 	QSharedPointer<DkPongSettings> settings() const;
 
 	DkArduinoController* getController();
+	DkHighscores* highscores();
 	DkPongPlayer* player1();
 	DkPongPlayer* player2();
+	const DkFixedStep& clock() const;
+
+	/**
+	 * Sets the base seed of the session.
+	 * Each match is seeded with DkRandom::matchSeed(seed, matchIndex).
+	 * @param seed the base seed.
+	 **/
+	void setSeed(quint64 seed);
+	quint64 matchSeed() const;
+
+	/**
+	 * Every match is recorded to this directory.
+	 * @param dirPath the replay directory, recording is disabled if it is empty.
+	 **/
+	void setReplayDir(const QString& dirPath);
+
+	/**
+	 * Plays a replay instead of the inputs of players & controllers.
+	 * @param filePath the replay file.
+	 * @return true if the replay could be loaded.
+	 **/
+	bool playReplay(const QString& filePath);
+	bool isReplaying() const;
+
+	/**
+	 * Input latency histograms are written to this file when the session ends.
+	 * @param filePath the CSV file.
+	 **/
+	void setLatencyLog(const QString& filePath);
+	void writeLatency() const;
+	const DkLatency& latency() const;
+
+	/**
+	 * Frames are rasterized by a render thread (default) or in paintEvent.
+	 * @param threaded if true, the GUI thread only presents finished frames.
+	 **/
+	void setRenderThread(bool threaded);
+
+	/**
+	 * Shows the timing of the last frames (tick rate, game loop, paint, frame interval)
+	 * and the controller's sample rate on top of the game.
+	 * @param show if true, the overlay is shown (toggle it with F3).
+	 **/
+	void setPerfOverlay(bool show);
+	bool perfOverlay() const;
+	const DkFrameStats& frameStats() const;
 
 	void start();
 
 public slots:
 	void gameLoop();
 	void countDown();
-	void controllerUpdate(int controller, int val);
+	void controllerUpdate(int controller, int val, qint64 stamp = 0);
+	void takeControllerValues();
+	void takeFrame();
+	void updatePerfOverlay();
 	void changeSpeed(int val);
 	void playerChanged(Screen screen, const QString& player);
 
@@ -325,9 +378,39 @@ protected:
 	void initGame();
 	void togglePause();
 	void pauseGame(bool pause = true);
+	void newMatch();
+	bool tick();
+
+	// all inputs that change the simulation (these are recorded)
+	void setPlayerPos(DkPongPlayer* player, float pos);
+	void setPlayerSpeed(DkPongPlayer* player, int speed);
+	void setBallSpeed(float speed);
+	QString replayPath() const;
+
+	// latency of the newest controller sample per player (0: none pending)
+	void dispatched(int playerIdx, qint64 stamp);
+	void simulated(int playerIdx);
+	void painted(quint64 tick);
+
+	QRect interpolate(const QRect& prev, const QRect& cur) const;
+
+	// dirty region updates
+	void objectRects(QRect* rects) const;
+	void updateDirty();
+	void updateRegion(const QRect* objects);
+
+	void updateLeaderboard();
+
+	// render thread
+	DkFrameState frameState() const;
+	void drawFrame(QPaintEvent* event);
+	void keepState();
 
 private:
 	QTimer *mEventLoop;
+	QElapsedTimer mClock;
+	DkFixedStep mStep;
+	double mAlpha = 1.0;
 	QTimer *mCountDownTimer;
 	int mCountDownSecs = 3;
 
@@ -335,17 +418,58 @@ private:
 	float mLastSpeedValue = -1.0f;
 
 	DkBall mBall;
+	quint64 mSeed = 0;
+	quint64 mMatchIdx = 0;
+	bool mNewMatch = true;
+	DkReplayWriter mRecorder;
+	QFutureSynchronizer<bool> mReplayWrites;	// waits for the replay writes when we are deleted
+	DkReplayReader mReplay;
+	QString mReplayDir;
+
+	DkLatency mLatency;
+	QString mLatencyLog;
+	qint64 mDispatchNs[2] = {0, 0};
+	qint64 mSimNs[2] = {0, 0};
+	quint64 mSimTick[2] = {0, 0};	// the first tick that shows the sample
+	quint64 mTick = 0;
+
 	DkPongPlayer* mPlayer1 = 0;
 	DkPongPlayer* mPlayer2 = 0;
 
+	// state of the previous tick (used for render interpolation)
+	QRect mPrevBall;
+	QRect mPrevPlayer1;
+	QRect mPrevPlayer2;
+
 	QSharedPointer<DkPongSettings> mS;
-	void drawField(QPainter& p);
+
+	// cached background & net (see fieldLayer)
+	QPixmap mFieldLayer;
+	QColor mFieldBg;
+	QColor mFieldFg;
+	int mFieldUnit = 0;
+	const QPixmap& fieldLayer();
+
+	QRegion mShown;				// where the ball & players are on screen
+	bool mFullUpdate = true;	// repaint everything with the next update
+
+	DkRenderThread* mRenderThread = 0;
+	QImage mFrame;				// the presented frame
+	DkFrameState mFrameState;
+
+	// performance overlay
+	DkFrameStats mFrameStats;
+	QLabel* mPerfOverlay = 0;
+	QTimer* mPerfTimer = 0;
+	quint64 mPerfSamples = 0;	// controller samples at the last update
+	qint64 mPerfNs = 0;
 
 	DkScoreLabel* mP1Score;
 	DkScoreLabel* mP2Score;
 
 	DkScoreLabel* mLargeInfo;
 	DkScoreLabel* mSmallInfo;
+	QLabel* mLeaderboard = 0;
 
 	DkHighscores* mHighscores;
 
@@ -0,0 +1,133 @@
+/*******************************************************************************************************
+
+ DkRenderThread.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+
+#include "DkRenderThread.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QMutexLocker>
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+// DkRenderThread --------------------------------------------------------------------
+DkRenderThread::DkRenderThread(QObject* parent) : QThread(parent) {
+}
+
+DkRenderThread::~DkRenderThread() {
+
+	quit();
+	wait();
+}
+
+void DkRenderThread::render(const DkFrameState& state) {
+
+	QMutexLocker lock(&mMutex);
+
+	if (mHasPending)
+		mSkipped++;
+
+	mPending = state;
+	mHasPending = true;
+	mWake.wakeOne();
+}
+
+QImage DkRenderThread::frame(DkFrameState& state) {
+
+	mNotified = false;
+
+	QMutexLocker lock(&mMutex);
+
+	if (mFront == -1)
+		return QImage();
+
+	state = mFrontState;
+	return mBuffers[mFront];
+}
+
+void DkRenderThread::quit() {
+
+	QMutexLocker lock(&mMutex);
+	mStop = true;
+	mWake.wakeOne();
+}
+
+quint64 DkRenderThread::renderedFrames() const {
+	return mRendered;
+}
+
+quint64 DkRenderThread::skippedFrames() const {
+	return mSkipped;
+}
+
+int DkRenderThread::backBuffer() const {
+
+	// prefer an image that is not referenced by the GUI anymore (no detach)
+	for (int idx = 0; idx < num_buffers; idx++) {
+		if (idx != mFront && (mBuffers[idx].isNull() || mBuffers[idx].isDetached()))
+			return idx;
+	}
+
+	return (mFront + 1) % num_buffers;
+}
+
+void DkRenderThread::run() {
+
+	forever {
+
+		DkFrameState state;
+		int back = 0;
+
+		{
+			QMutexLocker lock(&mMutex);
+
+			while (!mHasPending && !mStop)
+				mWake.wait(&mMutex);
+
+			if (mStop)
+				return;
+
+			state = mPending;
+			mHasPending = false;
+			back = backBuffer();
+		}
+
+		// only this thread writes to the back buffer - the GUI holds (shared) copies of finished frames
+		mRenderer.render(state, mBuffers[back]);
+		mRendered++;
+
+		{
+			QMutexLocker lock(&mMutex);
+			mFront = back;
+			mFrontState = state;
+		}
+
+		if (!mNotified.exchange(true))
+			emit frameReady();
+	}
+}
+
+}
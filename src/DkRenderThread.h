@@ -0,0 +1,117 @@
+/*******************************************************************************************************
+
+ DkRenderThread.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QImage>
+#include <atomic>
+#pragma warning(pop)		// no warnings from includes - end
+
+#include "render/DkRenderer.h"
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+namespace pong {
+
+/**
+ * Rasterizes frames off the GUI thread.
+ * The GUI thread posts DkFrameStates and presents the finished images.
+ * Frames are rendered into a small pool of images: the thread never
+ * writes to the image that is presented.
+ **/
+class DllExport DkRenderThread : public QThread {
+	Q_OBJECT
+
+public:
+	DkRenderThread(QObject* parent = 0);
+	~DkRenderThread();
+
+	/**
+	 * Requests a new frame (thread-safe).
+	 * A state that was not rendered yet is replaced.
+	 * @param state the frame's state.
+	 **/
+	void render(const DkFrameState& state);
+
+	/**
+	 * Returns the newest finished frame (thread-safe).
+	 * @param state the state of the frame.
+	 * @return the frame (null if nothing was rendered yet).
+	 **/
+	QImage frame(DkFrameState& state);
+
+	void quit();
+
+	quint64 renderedFrames() const;
+	quint64 skippedFrames() const;
+
+signals:
+	/**
+	 * Emitted if a frame is finished.
+	 * At most one signal is queued until frame() is called.
+	 **/
+	void frameReady() const;
+
+protected:
+	void run() override;
+
+	enum {
+		num_buffers = 3		// presented, finished & rendering
+	};
+
+	QMutex mMutex;
+	QWaitCondition mWake;
+	DkFrameState mPending;
+	bool mHasPending = false;
+	bool mStop = false;
+
+	QImage mBuffers[num_buffers];
+	int mFront = -1;
+	DkFrameState mFrontState;
+
+	DkFrameRenderer mRenderer;
+
+	std::atomic<bool> mNotified{false};
+	std::atomic<quint64> mRendered{0};
+	std::atomic<quint64> mSkipped{0};
+
+	int backBuffer() const;
+};
+
+}
@@ -0,0 +1,285 @@
+/*******************************************************************************************************
+
+ DkScoreWriter.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+
+#include "DkScoreWriter.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+// DkScoreWriter --------------------------------------------------------------------
+DkScoreWriter::DkScoreWriter(const QString& dbPath, QObject* parent) : QThread(parent) {
+
+	mPath = dbPath;
+
+	// connections are bound to a thread - so we need our own
+	mConnection = QString("pong-scores-%1").arg((quintptr)this);
+}
+
+DkScoreWriter::~DkScoreWriter() {
+
+	// pending scores are written before the thread stops
+	quit();
+	wait();
+}
+
+void DkScoreWriter::add(const DkScoreRecord& score) {
+
+	QMutexLocker lock(&mMutex);
+
+	mQueue.push_back(score);
+	mQueue.back().queuedNs = DkLatency::now();
+	mLeaderboard.add(score);
+	mMaxQueueDepth = qMax(mMaxQueueDepth, (int)mQueue.size() + mWriting);
+	mWake.wakeOne();
+}
+
+bool DkScoreWriter::flush(int timeoutMs) {
+
+	QElapsedTimer dt;
+	dt.start();
+
+	QMutexLocker lock(&mMutex);
+
+	while ((!mQueue.empty() || mWriting) && isRunning()) {
+
+		qint64 remaining = timeoutMs - dt.elapsed();
+
+		if (remaining <= 0 || !mDone.wait(&mMutex, (unsigned long)remaining))
+			break;
+	}
+
+	return mQueue.empty() && !mWriting;
+}
+
+void DkScoreWriter::quit() {
+
+	QMutexLocker lock(&mMutex);
+	mStop = true;
+	mWake.wakeOne();
+}
+
+void DkScoreWriter::setLeaderboard(const DkLeaderboard& leaderboard) {
+
+	QMutexLocker lock(&mMutex);
+	mLeaderboard = leaderboard;
+}
+
+std::vector<DkPlayerStats> DkScoreWriter::ranking(int maxPlayers) const {
+
+	QMutexLocker lock(&mMutex);
+	return mLeaderboard.ranking(maxPlayers);
+}
+
+int DkScoreWriter::queueDepth() const {
+
+	QMutexLocker lock(&mMutex);
+	return (int)mQueue.size() + mWriting;
+}
+
+int DkScoreWriter::maxQueueDepth() const {
+
+	QMutexLocker lock(&mMutex);
+	return mMaxQueueDepth;
+}
+
+quint64 DkScoreWriter::committed() const {
+
+	QMutexLocker lock(&mMutex);
+	return mCommitted;
+}
+
+quint64 DkScoreWriter::failed() const {
+
+	QMutexLocker lock(&mMutex);
+	return mFailed;
+}
+
+DkLatencyHistogram DkScoreWriter::commitLatency() const {
+
+	QMutexLocker lock(&mMutex);
+	return mCommitLatency;
+}
+
+DkLatencyHistogram DkScoreWriter::scoreLatency() const {
+
+	QMutexLocker lock(&mMutex);
+	return mScoreLatency;
+}
+
+QString DkScoreWriter::summary() const {
+
+	QMutexLocker lock(&mMutex);
+
+	return QString("scores: %1 committed, %2 failed, %3 pending (max %4) | commit: %5 transactions, p50 %6 ms, max %7 ms | score latency: p99 %8 ms")
+		.arg(mCommitted)
+		.arg(mFailed)
+		.arg((int)mQueue.size() + mWriting)
+		.arg(mMaxQueueDepth)
+		.arg(mCommitLatency.count())
+		.arg(mCommitLatency.percentile(0.5) / 1000.0, 0, 'f', 2)
+		.arg(mCommitLatency.max() / 1000.0, 0, 'f', 2)
+		.arg(mScoreLatency.percentile(0.99) / 1000.0, 0, 'f', 2);
+}
+
+void DkScoreWriter::run() {
+
+	{
+		QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", mConnection);
+		db.setDatabaseName(mPath);
+
+		if (!db.open())
+			qWarning() << "[DkScoreWriter] cannot open" << mPath << db.lastError();
+
+		forever {
+
+			std::vector<DkScoreRecord> batch;
+
+			{
+				QMutexLocker lock(&mMutex);
+
+				while (mQueue.empty() && !mStop)
+					mWake.wait(&mMutex);
+
+				// the queue is written before we stop
+				if (mQueue.empty())
+					break;
+
+				// group commit: everything that came in while we were writing
+				batch.swap(mQueue);
+				mWriting = (int)batch.size();
+			}
+
+			qint64 start = DkLatency::now();
+			bool ok = write(db, batch);
+			qint64 end = DkLatency::now();
+
+			std::vector<DkScoreRecord> committed;
+			std::vector<DkScoreRecord> failed;
+
+			if (ok)
+				committed.swap(batch);
+			else {
+				// a bad score must not take the others with it - retry them one by one
+				for (const DkScoreRecord& s : batch) {
+
+					if (write(db, std::vector<DkScoreRecord>(1, s)))
+						committed.push_back(s);
+					else
+						failed.push_back(s);
+				}
+				end = DkLatency::now();
+			}
+
+			// the in-memory leaderboard has the failed scores - go back to player_stats
+			DkLeaderboard stored;
+			bool reload = !failed.empty() && stored.load(db);
+
+			{
+				QMutexLocker lock(&mMutex);
+
+				mWriting = 0;
+				mCommitLatency.add(end - start);
+				mCommitted += committed.size();
+				mFailed += failed.size();
+
+				for (const DkScoreRecord& s : committed)
+					mScoreLatency.add(end - s.queuedNs);
+
+				if (reload) {
+
+					// scores that were queued meanwhile are not in the DB yet
+					for (const DkScoreRecord& s : mQueue)
+						stored.add(s);
+
+					mLeaderboard = stored;
+				}
+
+				mDone.wakeAll();
+			}
+
+			for (const DkScoreRecord& s : failed)
+				qWarning() << "[DkScoreWriter] dropped score" << s.winner << s.winnerPoints << ":" << s.looserPoints << s.looser;
+		}
+
+		db.close();
+	}
+
+	QSqlDatabase::removeDatabase(mConnection);
+}
+
+bool DkScoreWriter::write(QSqlDatabase& db, const std::vector<DkScoreRecord>& scores) const {
+
+	if (!db.isOpen())
+		return false;
+
+	if (!db.transaction()) {
+		qWarning() << "[DkScoreWriter] cannot start a transaction:" << db.lastError();
+		return false;
+	}
+
+	QSqlQuery query(db);
+	query.prepare("Insert into scores(winner_name, looser_name, winner_points, looser_points) "
+				  " VALUES (:winner, :looser, :winner_score, :looser_score)");
+
+	for (const DkScoreRecord& s : scores) {
+
+		query.bindValue(":winner", s.winner);
+		query.bindValue(":looser", s.looser);
+		query.bindValue(":winner_score", s.winnerPoints);
+		query.bindValue(":looser_score", s.looserPoints);
+
+		if (!query.exec()) {
+			qWarning() << "[DkScoreWriter] Error inserting score in table:" << query.lastError();
+			db.rollback();
+			return false;
+		}
+
+		// the summary is updated in the same transaction
+		if (!DkLeaderboard::update(db, s)) {
+			db.rollback();
+			return false;
+		}
+	}
+
+	if (!db.commit()) {
+		qWarning() << "[DkScoreWriter] cannot commit scores:" << db.lastError();
+		db.rollback();
+		return false;
+	}
+
+	return true;
+}
+
+}
@@ -0,0 +1,138 @@
+/*******************************************************************************************************
+
+ DkScoreWriter.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QString>
+#include <vector>
+#pragma warning(pop)		// no warnings from includes - end
+
+#include "engine/DkLatency.h"
+#include "DkLeaderboard.h"
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+class QSqlDatabase;
+
+namespace pong {
+
+/**
+ * Writes scores to the highscore DB off the GUI thread.
+ * Scores are queued and all scores that are pending when the
+ * thread wakes up are committed in one transaction (group commit)
+ * together with the player_stats updates (see DkLeaderboard).
+ * If that transaction fails, its scores are retried one by one so that
+ * only a bad score is lost (and taken out of the in-memory leaderboard).
+ * The thread uses its own DB connection.
+ **/
+class DllExport DkScoreWriter : public QThread {
+	Q_OBJECT
+
+public:
+	DkScoreWriter(const QString& dbPath, QObject* parent = 0);
+	~DkScoreWriter();
+
+	/**
+	 * Queues a score (thread-safe) - it never waits for the disk.
+	 * @param score the score.
+	 **/
+	void add(const DkScoreRecord& score);
+
+	/**
+	 * Waits until all queued scores are written (e.g. on shutdown).
+	 * @param timeoutMs the maximal time to wait.
+	 * @return true if all scores were written.
+	 **/
+	bool flush(int timeoutMs = 5000);
+
+	void quit();
+
+	/**
+	 * Sets the leaderboard that is read from the DB (call it before start).
+	 **/
+	void setLeaderboard(const DkLeaderboard& leaderboard);
+
+	/**
+	 * Returns the best players (thread-safe).
+	 * The in-memory leaderboard includes queued scores - it never waits for the DB.
+	 * @param maxPlayers the number of players (0: all).
+	 **/
+	std::vector<DkPlayerStats> ranking(int maxPlayers = 0) const;
+
+	// statistics (thread-safe)
+	int queueDepth() const;		// scores that are not committed yet
+	int maxQueueDepth() const;
+	quint64 committed() const;
+	quint64 failed() const;
+
+	/**
+	 * Duration of the transactions.
+	 **/
+	DkLatencyHistogram commitLatency() const;
+
+	/**
+	 * Time from add() until the score is committed.
+	 **/
+	DkLatencyHistogram scoreLatency() const;
+
+	QString summary() const;
+
+protected:
+	void run() override;
+	bool write(QSqlDatabase& db, const std::vector<DkScoreRecord>& scores) const;
+
+	QString mPath;
+	QString mConnection;
+
+	mutable QMutex mMutex;
+	QWaitCondition mWake;
+	QWaitCondition mDone;
+	std::vector<DkScoreRecord> mQueue;
+	int mWriting = 0;		// size of the batch that is written
+	bool mStop = false;
+
+	int mMaxQueueDepth = 0;
+	quint64 mCommitted = 0;
+	quint64 mFailed = 0;
+	DkLatencyHistogram mCommitLatency;
+	DkLatencyHistogram mScoreLatency;
+	DkLeaderboard mLeaderboard;
+};
+
+}
@@ -0,0 +1,172 @@
+/*******************************************************************************************************
+
+ DkThumbnailCache.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+
+#include "DkThumbnailCache.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QSaveFile>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QMutexLocker>
+#include <QDebug>
+#include <cstring>
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+static const char thumbnail_magic[4] = {'P', 'T', 'H', 'B'};
+static const quint32 thumbnail_version = 1;
+
+// the pixels follow the header
+struct DkThumbnailHeader {
+	char magic[4];
+	quint32 version;
+	qint32 width;
+	qint32 height;
+	qint32 bytesPerLine;
+	qint32 format;
+};
+
+// DkThumbnailCache --------------------------------------------------------------------
+DkThumbnailCache::DkThumbnailCache(const QString& dirPath) {
+
+	mDirPath = dirPath;
+
+	if (!QDir().mkpath(mDirPath))
+		qWarning() << "[DkThumbnailCache] cannot create" << mDirPath;
+}
+
+QString DkThumbnailCache::defaultDir() {
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+}
+
+QString DkThumbnailCache::key(const QByteArray& data) {
+	return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex());
+}
+
+QString DkThumbnailCache::filePath(const QString& key, int width) const {
+	return mDirPath + "/" + QString("%1-%2.thumb").arg(key).arg(width);
+}
+
+void DkThumbnailCache::use(const QString& fileName) {
+
+	QMutexLocker lock(&mMutex);
+	mUsed.insert(fileName);
+}
+
+QImage DkThumbnailCache::load(const QString& key, int width) {
+
+	QFile file(filePath(key, width));
+
+	if (!file.open(QIODevice::ReadOnly))
+		return QImage();
+
+	use(QFileInfo(file).fileName());
+
+	qint64 size = file.size();
+	if (size < (qint64)sizeof(DkThumbnailHeader))
+		return QImage();
+
+	const uchar* data = file.map(0, size);
+	if (!data)
+		return QImage();
+
+	DkThumbnailHeader h;
+	memcpy(&h, data, sizeof(h));
+
+	// corrupt or written by another version
+	if (memcmp(h.magic, thumbnail_magic, sizeof(h.magic)) != 0 ||
+		h.version != thumbnail_version ||
+		h.width != width || h.height <= 0 ||
+		h.format != QImage::Format_ARGB32_Premultiplied ||
+		h.bytesPerLine < h.width*4 ||
+		size != (qint64)sizeof(h) + (qint64)h.bytesPerLine*h.height) {
+		file.unmap((uchar*)data);
+		return QImage();
+	}
+
+	// the image references the mapping - copy it before unmapping
+	QImage img = QImage(data + sizeof(h), h.width, h.height, h.bytesPerLine, QImage::Format_ARGB32_Premultiplied).copy();
+	file.unmap((uchar*)data);
+
+	return img;
+}
+
+bool DkThumbnailCache::save(const QString& key, int width, const QImage& img) {
+
+	if (img.isNull() || img.width() != width)
+		return false;
+
+	QImage pixels = img.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+	DkThumbnailHeader h;
+	memcpy(h.magic, thumbnail_magic, sizeof(h.magic));
+	h.version = thumbnail_version;
+	h.width = pixels.width();
+	h.height = pixels.height();
+	h.bytesPerLine = pixels.bytesPerLine();
+	h.format = pixels.format();
+
+	// nobody sees half-written thumbnails
+	QSaveFile file(filePath(key, width));
+
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+
+	file.write((const char*)&h, sizeof(h));
+	file.write((const char*)pixels.constBits(), (qint64)h.bytesPerLine*h.height);
+
+	if (!file.commit()) {
+		qWarning() << "[DkThumbnailCache] cannot write" << file.fileName() << file.errorString();
+		return false;
+	}
+
+	use(QFileInfo(file.fileName()).fileName());
+
+	return true;
+}
+
+int DkThumbnailCache::removeUnused() const {
+
+	QMutexLocker lock(&mMutex);
+
+	int removed = 0;
+	QDir dir(mDirPath);
+
+	for (const QString& fileName : dir.entryList(QStringList() << "*.thumb", QDir::Files)) {
+
+		if (!mUsed.contains(fileName) && dir.remove(fileName))
+			removed++;
+	}
+
+	return removed;
+}
+
+}
@@ -0,0 +1,102 @@
+/*******************************************************************************************************
+
+ DkThumbnailCache.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QString>
+#include <QByteArray>
+#include <QImage>
+#include <QMutex>
+#include <QSet>
+#pragma warning(pop)		// no warnings from includes - end
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+namespace pong {
+
+/**
+ * Disk cache of scaled player pictures.
+ * Thumbnails are keyed by the SHA-1 of the encoded picture and its width,
+ * so a changed picture gets new thumbnails. They are stored as raw
+ * (premultiplied ARGB) pixels that are memory-mapped when loaded -
+ * decoding the JPEGs is only needed once.
+ **/
+class DllExport DkThumbnailCache {
+
+public:
+	DkThumbnailCache(const QString& dirPath = defaultDir());
+
+	static QString defaultDir();
+
+	/**
+	 * Returns the cache key of an encoded picture.
+	 * @param data the encoded picture (e.g. the BLOB of the DB).
+	 * @return the content hash (hex).
+	 **/
+	static QString key(const QByteArray& data);
+
+	/**
+	 * Loads a thumbnail (thread-safe).
+	 * @param key the picture's key (see key()).
+	 * @param width the thumbnail's width.
+	 * @return the thumbnail or a null image if it is not cached.
+	 **/
+	QImage load(const QString& key, int width);
+
+	/**
+	 * Stores a thumbnail (thread-safe).
+	 * @return true if it was written.
+	 **/
+	bool save(const QString& key, int width, const QImage& img);
+
+	/**
+	 * Deletes all thumbnails that were not loaded or saved by this instance
+	 * (e.g. of pictures that changed).
+	 * @return the number of deleted files.
+	 **/
+	int removeUnused() const;
+
+protected:
+	QString mDirPath;
+
+	mutable QMutex mMutex;
+	QSet<QString> mUsed;
+
+	QString filePath(const QString& key, int width) const;
+	void use(const QString& fileName);
+};
+
+}
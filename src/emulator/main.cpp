@@ -0,0 +1,466 @@
+/*******************************************************************************************************
+ 
+ main.cpp (pong-emulator)
+ Created on:	18.10.2026
+ 
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board. 
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QStringList>
+#include <QFile>
+#include <cmath>
+#include <vector>
+
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#pragma warning(pop)
+
+#include "engine/DkRandom.h"
+#include "DkMath.h"
+
+namespace pong {
+
+volatile sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+	stopRequested = 1;
+}
+
+/**
+ * An emulated analogue input of the Arduino board.
+ **/
+class DkEmulatedPin {
+
+public:
+	enum Wave {
+		wave_sine = 0,
+		wave_triangle,
+		wave_square,
+		wave_saw,
+		wave_random,
+
+		wave_end
+	};
+
+	DkEmulatedPin(int pin = 0, Wave wave = wave_sine, double freq = 0.5, double phase = 0.0) :
+		mPin(pin), mWave(wave), mFreq(freq), mPhase(phase) {}
+
+	static Wave wave(const QString& name, bool& ok) {
+
+		QStringList names = QStringList() << "sine" << "triangle" << "square" << "saw" << "random";
+		int idx = names.indexOf(name.toLower());
+		ok = idx != -1;
+
+		return ok ? (Wave)idx : wave_sine;
+	}
+
+	int pin() const {
+		return mPin;
+	}
+
+	/**
+	 * Samples the waveform.
+	 * @param sec the time since the emulator started.
+	 * @param rnd the emulator's random generator (for wave_random).
+	 * @return a 10 bit value (just like analogRead).
+	 **/
+	int value(double sec, DkRandom& rnd) const {
+
+		double t = sec * mFreq + mPhase;
+		t -= std::floor(t);
+		double v = 0.0;
+
+		switch (mWave) {
+		case wave_sine:		v = 0.5 + 0.5 * std::sin(t * 2.0 * DK_PI); break;
+		case wave_triangle:	v = t < 0.5 ? t * 2.0 : 2.0 - t * 2.0; break;
+		case wave_square:	v = t < 0.5 ? 0.0 : 1.0; break;
+		case wave_saw:		v = t; break;
+		case wave_random:	v = rnd.uniform(); break;
+		default: break;
+		}
+
+		return qBound(0, qRound(v * 1023.0), 1023);
+	}
+
+protected:
+	int mPin = 0;
+	Wave mWave = wave_sine;
+	double mFreq = 0.5;
+	double mPhase = 0.0;
+};
+
+/**
+ * Writes the controller's wire protocol to a pseudo-terminal.
+ * A frame is the marker 42 followed by a little endian unsigned short
+ * (pin << 10 | value) - see src/Arduino/controller/controller.ino.
+ **/
+class DkControllerEmulator {
+
+public:
+	DkControllerEmulator(quint64 seed) : mRandom(seed) {}
+
+	~DkControllerEmulator() {
+		close();
+	}
+
+	bool open() {
+
+		mMaster = posix_openpt(O_RDWR | O_NOCTTY);
+
+		if (mMaster == -1 || grantpt(mMaster) != 0 || unlockpt(mMaster) != 0) {
+			close();
+			return false;
+		}
+
+		mSlavePath = QString::fromLocal8Bit(ptsname(mMaster));
+
+		// the slave is kept open so that the pty survives reconnects of the game
+		mSlave = ::open(ptsname(mMaster), O_RDWR | O_NOCTTY);
+
+		if (mSlave == -1) {
+			close();
+			return false;
+		}
+
+		// raw mode: no echo & no line editing (the game sets this too when it opens the port)
+		termios tio;
+		if (tcgetattr(mSlave, &tio) == 0) {
+			cfmakeraw(&tio);
+			tcsetattr(mSlave, TCSANOW, &tio);
+		}
+
+		// a full buffer (nobody is reading) must not stall the emulator
+		fcntl(mMaster, F_SETFL, fcntl(mMaster, F_GETFL) | O_NONBLOCK);
+
+		return true;
+	}
+
+	void close() {
+
+		if (mSlave != -1)
+			::close(mSlave);
+		if (mMaster != -1)
+			::close(mMaster);
+
+		mSlave = -1;
+		mMaster = -1;
+	}
+
+	QString slavePath() const {
+		return mSlavePath;
+	}
+
+	void addPin(const DkEmulatedPin& pin) {
+		mPins.push_back(pin);
+	}
+
+	void setNoise(double probability) {
+		mNoise = probability;
+	}
+
+	void setDrops(double probability) {
+		mDrops = probability;
+	}
+
+	/**
+	 * Appends the frames of all pins (round robin) to the output buffer.
+	 * @param numFrames the number of frames.
+	 * @param sec the time of the frames.
+	 **/
+	void addFrames(quint64 numFrames, double sec) {
+
+		for (quint64 idx = 0; idx < numFrames; idx++) {
+
+			const DkEmulatedPin& pin = mPins[mFrames % mPins.size()];
+			quint16 word = (quint16)((pin.pin() << 10) | pin.value(sec, mRandom));
+
+			addByte(42);
+			addByte((char)(word & 0xFF));
+			addByte((char)(word >> 8));
+			mFrames++;
+		}
+	}
+
+	/**
+	 * Writes the output buffer to the pty.
+	 * Bytes that do not fit into the pty's buffer are discarded (and counted as overruns)
+	 * since the board does not wait for the host either.
+	 **/
+	void flush() {
+
+		if (mBuffer.empty())
+			return;
+
+		ssize_t written = ::write(mMaster, mBuffer.data(), mBuffer.size());
+
+		if (written < 0)
+			written = 0;
+
+		mBytes += written;
+		mOverruns += mBuffer.size() - written;
+		mBuffer.clear();
+
+		// discard whatever the game writes to us
+		char sink[256];
+		while (::read(mMaster, sink, sizeof(sink)) > 0)
+			;
+	}
+
+	quint64 frames() const { return mFrames; }
+	quint64 bytes() const { return mBytes; }
+	quint64 noiseBytes() const { return mNoiseBytes; }
+	quint64 droppedBytes() const { return mDroppedBytes; }
+	quint64 overruns() const { return mOverruns; }
+
+protected:
+	int mMaster = -1;
+	int mSlave = -1;
+	QString mSlavePath;
+
+	std::vector<DkEmulatedPin> mPins;
+	std::vector<char> mBuffer;
+	DkRandom mRandom;
+
+	double mNoise = 0.0;
+	double mDrops = 0.0;
+
+	quint64 mFrames = 0;
+	quint64 mBytes = 0;
+	quint64 mNoiseBytes = 0;
+	quint64 mDroppedBytes = 0;
+	quint64 mOverruns = 0;
+
+	void addByte(char byte) {
+
+		if (mNoise > 0.0 && mRandom.uniform() < mNoise) {
+			mBuffer.push_back((char)(mRandom.next() & 0xFF));
+			mNoiseBytes++;
+		}
+
+		if (mDrops > 0.0 && mRandom.uniform() < mDrops) {
+			mDroppedBytes++;
+			return;
+		}
+
+		mBuffer.push_back(byte);
+	}
+};
+
+}
+
+int main(int argc, char** argv) {
+
+	QCoreApplication::setOrganizationName("Vienna University of Technology");
+	QCoreApplication::setOrganizationDomain("http://www.nomacs.org");
+	QCoreApplication::setApplicationName("pong-emulator");
+
+	QCoreApplication app(argc, argv);
+
+	// CMD parser --------------------------------------------------------------------
+	QCommandLineParser parser;
+
+	parser.setApplicationDescription("Emulates the Arduino controller on a pseudo-terminal.\nRun Pong with --comport <pty> to connect.");
+	parser.addHelpOption();
+
+	QCommandLineOption pinsOpt(QStringList() << "p" << "pins",
+		QObject::tr("Comma separated <pins> that are emulated (default: 2,4,1 - player 1, player 2 & speed)."),
+		QObject::tr("pins"), "2,4,1");
+	parser.addOption(pinsOpt);
+
+	QCommandLineOption waveOpt(QStringList() << "w" << "wave",
+		QObject::tr("Comma separated <waves> per pin: sine, triangle, square, saw or random (default: sine)."),
+		QObject::tr("waves"), "sine");
+	parser.addOption(waveOpt);
+
+	QCommandLineOption freqOpt(QStringList() << "f" << "freq",
+		QObject::tr("Wave frequency in Hz (default: 0.5)."),
+		QObject::tr("freq"), "0.5");
+	parser.addOption(freqOpt);
+
+	QCommandLineOption rateOpt(QStringList() << "r" << "rate",
+		QObject::tr("Frames per second of all pins (default: 1000)."),
+		QObject::tr("rate"), "1000");
+	parser.addOption(rateOpt);
+
+	QCommandLineOption noiseOpt("noise",
+		QObject::tr("Probability of inserting a random byte before each byte (default: 0)."),
+		QObject::tr("probability"), "0");
+	parser.addOption(noiseOpt);
+
+	QCommandLineOption dropOpt("drop",
+		QObject::tr("Probability of dropping a byte (default: 0)."),
+		QObject::tr("probability"), "0");
+	parser.addOption(dropOpt);
+
+	QCommandLineOption durationOpt(QStringList() << "d" << "duration",
+		QObject::tr("Stop after <sec> seconds (default: 0 - run until interrupted)."),
+		QObject::tr("sec"), "0");
+	parser.addOption(durationOpt);
+
+	QCommandLineOption linkOpt("link",
+		QObject::tr("Create a symbolic link <path> to the pseudo-terminal (e.g. /tmp/pong-tty)."),
+		QObject::tr("path"));
+	parser.addOption(linkOpt);
+
+	QCommandLineOption seedOpt("seed",
+		QObject::tr("<seed> of the noise, drops & random waves (default: random)."),
+		QObject::tr("seed"));
+	parser.addOption(seedOpt);
+
+	parser.process(app);
+	// CMD parser --------------------------------------------------------------------
+
+	QTextStream out(stdout);
+
+	double rate = parser.value(rateOpt).toDouble();
+	double freq = parser.value(freqOpt).toDouble();
+	double noise = parser.value(noiseOpt).toDouble();
+	double drop = parser.value(dropOpt).toDouble();
+	double duration = parser.value(durationOpt).toDouble();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+	Qt::SplitBehavior skipEmpty = Qt::SkipEmptyParts;
+#else
+	QString::SplitBehavior skipEmpty = QString::SkipEmptyParts;
+#endif
+	QStringList pins = parser.value(pinsOpt).split(",", skipEmpty);
+	QStringList waves = parser.value(waveOpt).split(",", skipEmpty);
+
+	if (rate <= 0 || freq < 0 || noise < 0 || noise > 1 || drop < 0 || drop > 1 || pins.empty() || waves.empty()) {
+		out << "illegal arguments - see --help\n";
+		return 1;
+	}
+
+	bool seedOk = true;
+	quint64 seed = parser.isSet(seedOpt) ? parser.value(seedOpt).toULongLong(&seedOk, 0) : pong::DkRandom::randomSeed();
+
+	if (!seedOk) {
+		out << "illegal seed - see --help\n";
+		return 1;
+	}
+
+	pong::DkControllerEmulator emulator(seed);
+	emulator.setNoise(noise);
+	emulator.setDrops(drop);
+
+	for (int idx = 0; idx < pins.size(); idx++) {
+
+		bool ok = false;
+		int pin = pins[idx].trimmed().toInt(&ok);
+
+		// the pin has 6 bits
+		if (!ok || pin < 0 || pin > 63) {
+			out << "illegal pin " << pins[idx] << " - see --help\n";
+			return 1;
+		}
+
+		// the last wave is used for all remaining pins
+		pong::DkEmulatedPin::Wave wave = pong::DkEmulatedPin::wave(waves[qMin(idx, waves.size()-1)].trimmed(), ok);
+
+		if (!ok) {
+			out << "illegal wave " << waves[qMin(idx, waves.size()-1)] << " - see --help\n";
+			return 1;
+		}
+
+		// spread the phases so that the pins do not move in sync
+		emulator.addPin(pong::DkEmulatedPin(pin, wave, freq, (double)idx / pins.size()));
+	}
+
+	if (!emulator.open()) {
+		out << "cannot open a pseudo-terminal: " << strerror(errno) << "\n";
+		return 1;
+	}
+
+	QString link = parser.value(linkOpt);
+
+	if (!link.isEmpty()) {
+		QFile::remove(link);
+		if (!QFile::link(emulator.slavePath(), link))
+			out << "cannot create link " << link << "\n";
+	}
+
+	out << "emulating the controller on " << emulator.slavePath() << " (" << rate << " frames/sec)\n";
+	out << "run: Pong --comport " << (link.isEmpty() ? emulator.slavePath() : link) << "\n";
+	out.flush();
+
+	signal(SIGINT, pong::requestStop);
+	signal(SIGTERM, pong::requestStop);
+
+	// frames are written in 1 ms batches - single frames would need a syscall each at high rates
+	const long batchNs = 1000000;
+
+	QElapsedTimer dt;
+	dt.start();
+	double lastReport = 0.0;
+	quint64 lastFrames = 0;
+
+	while (!pong::stopRequested) {
+
+		double sec = dt.nsecsElapsed() / 1e9;
+
+		if (duration > 0 && sec >= duration)
+			break;
+
+		quint64 due = (quint64)(sec * rate);
+
+		if (due > emulator.frames()) {
+			emulator.addFrames(due - emulator.frames(), sec);
+			emulator.flush();
+		}
+
+		if (sec - lastReport >= 1.0) {
+			out << "frames: " << emulator.frames() << " (" << qRound((emulator.frames() - lastFrames) / (sec - lastReport)) << "/sec)"
+				<< " noise: " << emulator.noiseBytes() << " dropped: " << emulator.droppedBytes()
+				<< " overruns: " << emulator.overruns() << "\n";
+			out.flush();
+			lastReport = sec;
+			lastFrames = emulator.frames();
+		}
+
+		timespec ts = {0, batchNs};
+		nanosleep(&ts, 0);
+	}
+
+	double sec = dt.nsecsElapsed() / 1e9;
+
+	out << "\nseed:      " << seed << "\n";
+	out << "time:      " << sec << " sec\n";
+	out << "frames:    " << emulator.frames() << " (" << (sec > 0 ? emulator.frames() / sec : 0.0) << "/sec)\n";
+	out << "bytes:     " << emulator.bytes() << "\n";
+	out << "noise:     " << emulator.noiseBytes() << " bytes\n";
+	out << "dropped:   " << emulator.droppedBytes() << " bytes\n";
+	out << "overruns:  " << emulator.overruns() << " bytes (nobody was reading)\n";
+
+	if (!link.isEmpty())
+		QFile::remove(link);
+
+	return 0;
+}
@@ -0,0 +1,247 @@
+/*******************************************************************************************************
+
+ DkBallKernel.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#include "DkBallKernel.h"
+#include "DkBatchEngine.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <cmath>
+#if defined(_MSC_VER) && (defined(DK_WITH_SSE4) || defined(DK_WITH_AVX2))
+#include <intrin.h>
+#endif
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+// the direction's angle is clamped to +/- (pi/2 - pi/5) w.r.t. the x-axis (see DkEngineBall::fixAngle)
+static const float kMaxSlope = 1.37638192f;		// tan(0.3*pi)
+static const float kClampCos = 0.58778525f;		// cos(0.3*pi)
+static const float kClampSin = 0.80901699f;		// sin(0.3*pi)
+
+// stepBallsScalar --------------------------------------------------------------------
+void stepBallsScalar(const DkBallKernelParams& p, const DkBallArrays& a, int begin, int end, unsigned char* events) {
+
+	const float hu = p.halfUnit;
+	const float ph = p.playerHeight;
+
+	for (int idx = begin; idx < end; idx++) {
+
+		float x = a.ballX[idx];
+		float y = a.ballY[idx];
+		float dx = a.dirX[idx];
+		float dy = a.dirY[idx];
+
+		// normalize
+		float n = std::sqrt(dx*dx + dy*dy);
+		if (n > 0.0f) {
+			dx = dx / n;
+			dy = dy / n;
+		}
+
+		// keep the ball away from vertical directions
+		if (std::abs(dy) > kMaxSlope*std::abs(dx)) {
+			dx = std::copysign(kClampCos, dx);
+			dy = std::copysign(kClampSin, dy);
+		}
+
+		float spd = qMin(qMax(a.speed[idx], p.minSpeed), p.maxSpeed);
+		float vx = dx*spd;
+		float vy = dy*spd;
+
+		// collision detection top & bottom
+		if ((y - hu <= 0.0f && vy < 0.0f) || (y + hu >= p.fieldHeight && vy > 0.0f)) {
+			vy = -vy;
+			dy = -dy;
+		}
+
+		float nx = x + vx;
+		float ny = y + vy;
+
+		a.dirX[idx] = dx;
+		a.dirY[idx] = dy;
+
+		// player collision: either the rects intersect or the ball crosses the player's center line
+		bool left = vx < 0.0f;
+		float pTop = left ? a.player1Top[idx] : a.player2Top[idx];
+		float pX = left ? p.player1X : p.player2X;
+
+		bool intersects = std::abs(x - pX) < 2.0f*hu && y + hu > pTop && y - hu < pTop + ph;
+		bool crosses = (x - pX) * (nx - pX) <= 0.0f && qMin(y, ny) >= pTop && qMax(y, ny) <= pTop + ph;
+
+		if (vx != 0.0f && (intersects || crosses))
+			events[idx] = left ? ball_hit_player1 : ball_hit_player2;
+		else if (x - hu <= 0.0f)
+			events[idx] = ball_out_left;
+		else if (x + hu >= p.fieldWidth)
+			events[idx] = ball_out_right;
+		else {
+			events[idx] = ball_moved;
+			a.ballX[idx] = nx;
+			a.ballY[idx] = ny;
+		}
+	}
+}
+
+#if defined(DK_WITH_SSE4)
+static bool cpuHasSse4() {
+
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 19)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse4.1") != 0;
+#endif
+}
+#endif
+
+#if defined(DK_WITH_AVX2)
+static bool cpuHasAvx2() {
+
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+
+	// the OS must save the ymm registers
+	if (maxLeaf < 7 || !osxsave || (_xgetbv(0) & 0x6) != 0x6)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
+
+// DkBallKernel --------------------------------------------------------------------
+void DkBallKernel::stepScalar(const DkBallKernelParams& p, DkBatchState& s, int begin, int end, quint8* events) {
+	stepBallsScalar(p, arrays(s), begin, end, events);
+}
+
+void DkBallKernel::stepSse4(const DkBallKernelParams& p, DkBatchState& s, int begin, int end, quint8* events) {
+#if defined(DK_WITH_SSE4)
+	stepBallsSse4(p, arrays(s), begin, end, events);
+#else
+	stepScalar(p, s, begin, end, events);
+#endif
+}
+
+void DkBallKernel::stepAvx2(const DkBallKernelParams& p, DkBatchState& s, int begin, int end, quint8* events) {
+#if defined(DK_WITH_AVX2)
+	stepBallsAvx2(p, arrays(s), begin, end, events);
+#else
+	stepScalar(p, s, begin, end, events);
+#endif
+}
+
+DkBallArrays DkBallKernel::arrays(DkBatchState& s) {
+
+	DkBallArrays a;
+	a.ballX = s.ballX.data();
+	a.ballY = s.ballY.data();
+	a.dirX = s.dirX.data();
+	a.dirY = s.dirY.data();
+	a.speed = s.speed.data();
+	a.player1Top = s.player1Top.data();
+	a.player2Top = s.player2Top.data();
+
+	return a;
+}
+
+bool DkBallKernel::available(InstructionSet isa) {
+
+	switch (isa) {
+	case isa_scalar:	return true;
+#if defined(DK_WITH_SSE4)
+	case isa_sse4:		return cpuHasSse4();
+#endif
+#if defined(DK_WITH_AVX2)
+	case isa_avx2:		return cpuHasAvx2();
+#endif
+	default:			return false;
+	}
+}
+
+const char* DkBallKernel::name(InstructionSet isa) {
+
+	switch (isa) {
+	case isa_avx2:	return "avx2";
+	case isa_sse4:	return "sse4.1";
+	default:		return "scalar";
+	}
+}
+
+// the instruction set is chosen at runtime - the rest of the engine is compiled for the baseline
+DkBallKernel::InstructionSet DkBallKernel::detect() {
+
+	if (available(isa_avx2))
+		return isa_avx2;
+	if (available(isa_sse4))
+		return isa_sse4;
+
+	return isa_scalar;
+}
+
+DkBallKernel::InstructionSet DkBallKernel::isa() {
+
+	static const InstructionSet s = detect();
+	return s;
+}
+
+void DkBallKernel::step(const DkBallKernelParams& p, DkBatchState& s, int begin, int end, quint8* events) {
+
+	switch (isa()) {
+#if defined(DK_WITH_AVX2)
+	case isa_avx2:	stepAvx2(p, s, begin, end, events); return;
+#endif
+#if defined(DK_WITH_SSE4)
+	case isa_sse4:	stepSse4(p, s, begin, end, events); return;
+#endif
+	default:		stepScalar(p, s, begin, end, events); return;
+	}
+}
+
+const char* DkBallKernel::instructionSet() {
+	return name(isa());
+}
+
+int DkBallKernel::width() {
+
+	switch (isa()) {
+	case isa_avx2:	return 8;
+	case isa_sse4:	return 4;
+	default:		return 1;
+	}
+}
+
+}
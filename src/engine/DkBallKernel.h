@@ -0,0 +1,112 @@
+/*******************************************************************************************************
+
+ DkBallKernel.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QtGlobal>
+#pragma warning(pop)		// no warnings from includes - end
+
+#include "DkBallKernelTypes.h"
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+namespace pong {
+
+struct DkBatchState;
+
+/**
+ * Advances many balls by one tick: normalize, angle clamping, wall reflection & player collision test.
+ * Paddle deflections and points are rare and left to the caller (see DkBatchEngine::step).
+ **/
+class DllExport DkBallKernel {
+
+public:
+
+	/**
+	 * Runs the vectorized kernel (AVX2: 8 balls, SSE4.1: 4 balls per instruction).
+	 * The best kernel that was compiled (see SIMD_KERNEL) and that the CPU supports is
+	 * chosen at runtime - it falls back to the scalar kernel.
+	 * @param p the field parameters.
+	 * @param s the batch state.
+	 * @param begin the first ball.
+	 * @param end one past the last ball.
+	 * @param events one DkBallEvent per ball.
+	 **/
+	static void step(const DkBallKernelParams& p, DkBatchState& s, int begin, int end, quint8* events);
+
+	/**
+	 * The reference implementation.
+	 **/
+	static void stepScalar(const DkBallKernelParams& p, DkBatchState& s, int begin, int end, quint8* events);
+
+	/**
+	 * Returns the instruction set that is used by step().
+	 * @return "avx2", "sse4.1" or "scalar".
+	 **/
+	static const char* instructionSet();
+
+	/**
+	 * Number of balls that are processed per instruction stream.
+	 **/
+	static int width();
+
+	enum InstructionSet {
+		isa_scalar = 0,
+		isa_sse4,
+		isa_avx2,
+
+		isa_end
+	};
+
+	/**
+	 * The vectorized kernels - only call them if their instruction set is available.
+	 **/
+	static void stepSse4(const DkBallKernelParams& p, DkBatchState& s, int begin, int end, quint8* events);
+	static void stepAvx2(const DkBallKernelParams& p, DkBatchState& s, int begin, int end, quint8* events);
+
+	/**
+	 * Returns true if the kernel was compiled (see SIMD_KERNEL) and the CPU supports it.
+	 * @param isa the instruction set.
+	 **/
+	static bool available(InstructionSet isa);
+	static const char* name(InstructionSet isa);
+
+protected:
+	static InstructionSet isa();
+	static InstructionSet detect();
+	static DkBallArrays arrays(DkBatchState& s);
+};
+
+}
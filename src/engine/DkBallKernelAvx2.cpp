@@ -0,0 +1,162 @@
+/*******************************************************************************************************
+
+ DkBallKernelAvx2.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+
+// this file is compiled with AVX2 enabled (see CMakeLists.txt) - only call it if the CPU supports it
+// (DkBallKernel::step checks). Do not use inline functions of other headers here: the linker
+// could pick this file's AVX2 instance for the whole program.
+#include "DkBallKernelTypes.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#if defined(DK_WITH_AVX2)
+#include <immintrin.h>
+#endif
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+#if defined(DK_WITH_AVX2)
+
+// the direction's angle is clamped to +/- (pi/2 - pi/5) w.r.t. the x-axis (see DkEngineBall::fixAngle)
+static const float kMaxSlope = 1.37638192f;		// tan(0.3*pi)
+static const float kClampCos = 0.58778525f;		// cos(0.3*pi)
+static const float kClampSin = 0.80901699f;		// sin(0.3*pi)
+
+// stepBallsAvx2 --------------------------------------------------------------------
+void stepBallsAvx2(const DkBallKernelParams& p, const DkBallArrays& a, int begin, int end, unsigned char* events) {
+
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	const __m256 maxSlope = _mm256_set1_ps(kMaxSlope);
+	const __m256 clampCos = _mm256_set1_ps(kClampCos);
+	const __m256 clampSin = _mm256_set1_ps(kClampSin);
+	const __m256 hu = _mm256_set1_ps(p.halfUnit);
+	const __m256 unit = _mm256_set1_ps(2.0f*p.halfUnit);
+	const __m256 ph = _mm256_set1_ps(p.playerHeight);
+	const __m256 fw = _mm256_set1_ps(p.fieldWidth);
+	const __m256 fh = _mm256_set1_ps(p.fieldHeight);
+	const __m256 p1X = _mm256_set1_ps(p.player1X);
+	const __m256 p2X = _mm256_set1_ps(p.player2X);
+	const __m256 minSpeed = _mm256_set1_ps(p.minSpeed);
+	const __m256 maxSpeed = _mm256_set1_ps(p.maxSpeed);
+
+	int idx = begin;
+
+	for (; idx + 8 <= end; idx += 8) {
+
+		__m256 x = _mm256_loadu_ps(a.ballX + idx);
+		__m256 y = _mm256_loadu_ps(a.ballY + idx);
+		__m256 dx = _mm256_loadu_ps(a.dirX + idx);
+		__m256 dy = _mm256_loadu_ps(a.dirY + idx);
+
+		// normalize
+		__m256 n = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+		__m256 valid = _mm256_cmp_ps(n, zero, _CMP_GT_OQ);
+		dx = _mm256_blendv_ps(dx, _mm256_div_ps(dx, n), valid);
+		dy = _mm256_blendv_ps(dy, _mm256_div_ps(dy, n), valid);
+
+		// keep the ball away from vertical directions
+		__m256 adx = _mm256_andnot_ps(signMask, dx);
+		__m256 ady = _mm256_andnot_ps(signMask, dy);
+		__m256 steep = _mm256_cmp_ps(ady, _mm256_mul_ps(maxSlope, adx), _CMP_GT_OQ);
+		dx = _mm256_blendv_ps(dx, _mm256_or_ps(clampCos, _mm256_and_ps(signMask, dx)), steep);
+		dy = _mm256_blendv_ps(dy, _mm256_or_ps(clampSin, _mm256_and_ps(signMask, dy)), steep);
+
+		__m256 spd = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(a.speed + idx), minSpeed), maxSpeed);
+		__m256 vx = _mm256_mul_ps(dx, spd);
+		__m256 vy = _mm256_mul_ps(dy, spd);
+
+		// collision detection top & bottom
+		__m256 top = _mm256_and_ps(_mm256_cmp_ps(_mm256_sub_ps(y, hu), zero, _CMP_LE_OQ), _mm256_cmp_ps(vy, zero, _CMP_LT_OQ));
+		__m256 bottom = _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(y, hu), fh, _CMP_GE_OQ), _mm256_cmp_ps(vy, zero, _CMP_GT_OQ));
+		__m256 flip = _mm256_and_ps(_mm256_or_ps(top, bottom), signMask);
+		vy = _mm256_xor_ps(vy, flip);
+		dy = _mm256_xor_ps(dy, flip);
+
+		__m256 nx = _mm256_add_ps(x, vx);
+		__m256 ny = _mm256_add_ps(y, vy);
+
+		_mm256_storeu_ps(a.dirX + idx, dx);
+		_mm256_storeu_ps(a.dirY + idx, dy);
+
+		// player collision
+		__m256 yMin = _mm256_min_ps(y, ny);
+		__m256 yMax = _mm256_max_ps(y, ny);
+		__m256 yTop = _mm256_sub_ps(y, hu);
+		__m256 yBottom = _mm256_add_ps(y, hu);
+
+		__m256 hits[2];
+		const __m256 pXs[2] = {p1X, p2X};
+		const float* pTops[2] = {a.player1Top + idx, a.player2Top + idx};
+
+		for (int pIdx = 0; pIdx < 2; pIdx++) {
+
+			__m256 pTop = _mm256_loadu_ps(pTops[pIdx]);
+			__m256 pBottom = _mm256_add_ps(pTop, ph);
+			__m256 rx = _mm256_sub_ps(x, pXs[pIdx]);
+
+			__m256 intersects = _mm256_and_ps(
+				_mm256_cmp_ps(_mm256_andnot_ps(signMask, rx), unit, _CMP_LT_OQ),
+				_mm256_and_ps(_mm256_cmp_ps(yBottom, pTop, _CMP_GT_OQ), _mm256_cmp_ps(yTop, pBottom, _CMP_LT_OQ)));
+
+			__m256 crosses = _mm256_and_ps(
+				_mm256_cmp_ps(_mm256_mul_ps(rx, _mm256_sub_ps(nx, pXs[pIdx])), zero, _CMP_LE_OQ),
+				_mm256_and_ps(_mm256_cmp_ps(yMin, pTop, _CMP_GE_OQ), _mm256_cmp_ps(yMax, pBottom, _CMP_LE_OQ)));
+
+			hits[pIdx] = _mm256_or_ps(intersects, crosses);
+		}
+
+		__m256 hit1 = _mm256_and_ps(_mm256_cmp_ps(vx, zero, _CMP_LT_OQ), hits[0]);
+		__m256 hit2 = _mm256_and_ps(_mm256_cmp_ps(vx, zero, _CMP_GT_OQ), hits[1]);
+		__m256 outL = _mm256_cmp_ps(_mm256_sub_ps(x, hu), zero, _CMP_LE_OQ);
+		__m256 outR = _mm256_cmp_ps(_mm256_add_ps(x, hu), fw, _CMP_GE_OQ);
+		__m256 any = _mm256_or_ps(_mm256_or_ps(hit1, hit2), _mm256_or_ps(outL, outR));
+
+		_mm256_storeu_ps(a.ballX + idx, _mm256_blendv_ps(nx, x, any));
+		_mm256_storeu_ps(a.ballY + idx, _mm256_blendv_ps(ny, y, any));
+
+		int m1 = _mm256_movemask_ps(hit1);
+		int m2 = _mm256_movemask_ps(hit2);
+		int mL = _mm256_movemask_ps(outL);
+		int mR = _mm256_movemask_ps(outR);
+
+		for (int k = 0; k < 8; k++) {
+			unsigned char e = ball_moved;
+			if (m1 >> k & 1)		e = ball_hit_player1;
+			else if (m2 >> k & 1)	e = ball_hit_player2;
+			else if (mL >> k & 1)	e = ball_out_left;
+			else if (mR >> k & 1)	e = ball_out_right;
+			events[idx+k] = e;
+		}
+	}
+
+	// remaining balls
+	stepBallsScalar(p, a, idx, end, events);
+}
+
+#endif
+
+}
@@ -0,0 +1,162 @@
+/*******************************************************************************************************
+
+ DkBallKernelSse4.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+
+// this file is compiled with SSE4.1 enabled (see CMakeLists.txt) - only call it if the CPU supports it
+// (DkBallKernel::step checks). Do not use inline functions of other headers here: the linker
+// could pick this file's SSE4.1 instance for the whole program.
+#include "DkBallKernelTypes.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#if defined(DK_WITH_SSE4)
+#include <smmintrin.h>
+#endif
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+#if defined(DK_WITH_SSE4)
+
+// the direction's angle is clamped to +/- (pi/2 - pi/5) w.r.t. the x-axis (see DkEngineBall::fixAngle)
+static const float kMaxSlope = 1.37638192f;		// tan(0.3*pi)
+static const float kClampCos = 0.58778525f;		// cos(0.3*pi)
+static const float kClampSin = 0.80901699f;		// sin(0.3*pi)
+
+// stepBallsSse4 --------------------------------------------------------------------
+void stepBallsSse4(const DkBallKernelParams& p, const DkBallArrays& a, int begin, int end, unsigned char* events) {
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 maxSlope = _mm_set1_ps(kMaxSlope);
+	const __m128 clampCos = _mm_set1_ps(kClampCos);
+	const __m128 clampSin = _mm_set1_ps(kClampSin);
+	const __m128 hu = _mm_set1_ps(p.halfUnit);
+	const __m128 unit = _mm_set1_ps(2.0f*p.halfUnit);
+	const __m128 ph = _mm_set1_ps(p.playerHeight);
+	const __m128 fw = _mm_set1_ps(p.fieldWidth);
+	const __m128 fh = _mm_set1_ps(p.fieldHeight);
+	const __m128 p1X = _mm_set1_ps(p.player1X);
+	const __m128 p2X = _mm_set1_ps(p.player2X);
+	const __m128 minSpeed = _mm_set1_ps(p.minSpeed);
+	const __m128 maxSpeed = _mm_set1_ps(p.maxSpeed);
+
+	int idx = begin;
+
+	for (; idx + 4 <= end; idx += 4) {
+
+		__m128 x = _mm_loadu_ps(a.ballX + idx);
+		__m128 y = _mm_loadu_ps(a.ballY + idx);
+		__m128 dx = _mm_loadu_ps(a.dirX + idx);
+		__m128 dy = _mm_loadu_ps(a.dirY + idx);
+
+		// normalize
+		__m128 n = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+		__m128 valid = _mm_cmpgt_ps(n, zero);
+		dx = _mm_blendv_ps(dx, _mm_div_ps(dx, n), valid);
+		dy = _mm_blendv_ps(dy, _mm_div_ps(dy, n), valid);
+
+		// keep the ball away from vertical directions
+		__m128 adx = _mm_andnot_ps(signMask, dx);
+		__m128 ady = _mm_andnot_ps(signMask, dy);
+		__m128 steep = _mm_cmpgt_ps(ady, _mm_mul_ps(maxSlope, adx));
+		dx = _mm_blendv_ps(dx, _mm_or_ps(clampCos, _mm_and_ps(signMask, dx)), steep);
+		dy = _mm_blendv_ps(dy, _mm_or_ps(clampSin, _mm_and_ps(signMask, dy)), steep);
+
+		__m128 spd = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(a.speed + idx), minSpeed), maxSpeed);
+		__m128 vx = _mm_mul_ps(dx, spd);
+		__m128 vy = _mm_mul_ps(dy, spd);
+
+		// collision detection top & bottom
+		__m128 top = _mm_and_ps(_mm_cmple_ps(_mm_sub_ps(y, hu), zero), _mm_cmplt_ps(vy, zero));
+		__m128 bottom = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(y, hu), fh), _mm_cmpgt_ps(vy, zero));
+		__m128 flip = _mm_and_ps(_mm_or_ps(top, bottom), signMask);
+		vy = _mm_xor_ps(vy, flip);
+		dy = _mm_xor_ps(dy, flip);
+
+		__m128 nx = _mm_add_ps(x, vx);
+		__m128 ny = _mm_add_ps(y, vy);
+
+		_mm_storeu_ps(a.dirX + idx, dx);
+		_mm_storeu_ps(a.dirY + idx, dy);
+
+		// player collision
+		__m128 yMin = _mm_min_ps(y, ny);
+		__m128 yMax = _mm_max_ps(y, ny);
+		__m128 yTop = _mm_sub_ps(y, hu);
+		__m128 yBottom = _mm_add_ps(y, hu);
+
+		__m128 hits[2];
+		const __m128 pXs[2] = {p1X, p2X};
+		const float* pTops[2] = {a.player1Top + idx, a.player2Top + idx};
+
+		for (int pIdx = 0; pIdx < 2; pIdx++) {
+
+			__m128 pTop = _mm_loadu_ps(pTops[pIdx]);
+			__m128 pBottom = _mm_add_ps(pTop, ph);
+			__m128 rx = _mm_sub_ps(x, pXs[pIdx]);
+
+			__m128 intersects = _mm_and_ps(
+				_mm_cmplt_ps(_mm_andnot_ps(signMask, rx), unit),
+				_mm_and_ps(_mm_cmpgt_ps(yBottom, pTop), _mm_cmplt_ps(yTop, pBottom)));
+
+			__m128 crosses = _mm_and_ps(
+				_mm_cmple_ps(_mm_mul_ps(rx, _mm_sub_ps(nx, pXs[pIdx])), zero),
+				_mm_and_ps(_mm_cmpge_ps(yMin, pTop), _mm_cmple_ps(yMax, pBottom)));
+
+			hits[pIdx] = _mm_or_ps(intersects, crosses);
+		}
+
+		__m128 hit1 = _mm_and_ps(_mm_cmplt_ps(vx, zero), hits[0]);
+		__m128 hit2 = _mm_and_ps(_mm_cmpgt_ps(vx, zero), hits[1]);
+		__m128 outL = _mm_cmple_ps(_mm_sub_ps(x, hu), zero);
+		__m128 outR = _mm_cmpge_ps(_mm_add_ps(x, hu), fw);
+		__m128 any = _mm_or_ps(_mm_or_ps(hit1, hit2), _mm_or_ps(outL, outR));
+
+		_mm_storeu_ps(a.ballX + idx, _mm_blendv_ps(nx, x, any));
+		_mm_storeu_ps(a.ballY + idx, _mm_blendv_ps(ny, y, any));
+
+		int m1 = _mm_movemask_ps(hit1);
+		int m2 = _mm_movemask_ps(hit2);
+		int mL = _mm_movemask_ps(outL);
+		int mR = _mm_movemask_ps(outR);
+
+		for (int k = 0; k < 4; k++) {
+			unsigned char e = ball_moved;
+			if (m1 >> k & 1)		e = ball_hit_player1;
+			else if (m2 >> k & 1)	e = ball_hit_player2;
+			else if (mL >> k & 1)	e = ball_out_left;
+			else if (mR >> k & 1)	e = ball_out_right;
+			events[idx+k] = e;
+		}
+	}
+
+	// remaining balls
+	stepBallsScalar(p, a, idx, end, events);
+}
+
+#endif
+
+}
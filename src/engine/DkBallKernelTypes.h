@@ -0,0 +1,80 @@
+/*******************************************************************************************************
+
+ DkBallKernelTypes.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#pragma once
+
+// plain data only: the kernel files that are compiled with SSE4.1/AVX2 include this
+// header (and no other), so that no inline function is compiled with their instruction set
+
+namespace pong {
+
+/**
+ * Field parameters that are shared by all balls of a batch.
+ **/
+struct DkBallKernelParams {
+	float fieldWidth = 0.0f;
+	float fieldHeight = 0.0f;
+	float halfUnit = 0.0f;		// half ball size
+	float playerHeight = 0.0f;
+	float player1X = 0.0f;		// paddle center x
+	float player2X = 0.0f;
+	float minSpeed = 0.0f;
+	float maxSpeed = 0.0f;
+};
+
+/**
+ * Per-ball results of a kernel step.
+ * Balls with an event are not advanced - the caller resolves them.
+ **/
+enum DkBallEvent {
+	ball_moved = 0,
+	ball_hit_player1,
+	ball_hit_player2,
+	ball_out_left,		// player 2 scores
+	ball_out_right,		// player 1 scores
+
+	ball_end
+};
+
+/**
+ * The ball & paddle arrays of a DkBatchState.
+ **/
+struct DkBallArrays {
+	float* ballX;
+	float* ballY;
+	float* dirX;
+	float* dirY;
+	const float* speed;
+	const float* player1Top;
+	const float* player2Top;
+};
+
+// the kernels (see DkBallKernel) - stepBallsSse4 & stepBallsAvx2 are compiled with their instruction set
+void stepBallsScalar(const DkBallKernelParams& p, const DkBallArrays& a, int begin, int end, unsigned char* events);
+void stepBallsSse4(const DkBallKernelParams& p, const DkBallArrays& a, int begin, int end, unsigned char* events);
+void stepBallsAvx2(const DkBallKernelParams& p, const DkBallArrays& a, int begin, int end, unsigned char* events);
+
+}
@@ -0,0 +1,349 @@
+/*******************************************************************************************************
+
+ DkBatchEngine.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#include "DkBatchEngine.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <cmath>
+#include <cstdlib>
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+// the direction's angle is clamped to +/- (pi/2 - pi/5) w.r.t. the x-axis (see DkEngineBall::fixAngle)
+static const float kMaxSlope = 1.37638192f;		// tan(0.3*pi)
+static const float kClampCos = 0.58778525f;		// cos(0.3*pi)
+static const float kClampSin = 0.80901699f;		// sin(0.3*pi)
+static const float kHorizontalSlope = 0.0100003f;	// tan(0.01)
+
+// DkBatchState --------------------------------------------------------------------
+void DkBatchState::resize(int numMatches) {
+
+	size_t n = (size_t)qMax(numMatches, 0);
+
+	ballX.resize(n);
+	ballY.resize(n);
+	dirX.resize(n);
+	dirY.resize(n);
+	speed.resize(n);
+
+	player1Top.resize(n);
+	player2Top.resize(n);
+	player1Velocity.resize(n);
+	player2Velocity.resize(n);
+	player1Speed.resize(n);
+	player2Speed.resize(n);
+
+	score1.resize(n);
+	score2.resize(n);
+	rally.resize(n);
+	wins1.resize(n);
+	wins2.resize(n);
+
+	random.resize(n);
+	seed.resize(n);
+}
+
+int DkBatchState::size() const {
+	return (int)ballX.size();
+}
+
+// DkBatchEngine --------------------------------------------------------------------
+DkBatchEngine::DkBatchEngine(const DkEngineSettings& settings, int numMatches) {
+
+	const QRect& f = settings.field();
+	float unit = (float)settings.unit();
+
+	mFieldWidth = (float)f.width();
+	mFieldHeight = (float)f.height();
+	mHalfUnit = unit * 0.5f;
+	mPlayerHeight = (float)qRound(f.height()*settings.playerRatio());
+	mPlayer1X = unit;
+	mPlayer2X = (float)qRound(f.width()-unit*1.5f);
+	mPlayerSpeed = (float)qRound(f.width()*0.007);
+
+	// same as DkEngineBall::updateSize
+	mMinSpeed = (float)qRound(f.width()*0.005);
+	mMaxSpeed = (float)qRound(f.width()*0.02);
+	mStartSpeed = qBound(mMinSpeed, settings.speed(), mMaxSpeed);
+	mTotalScore = settings.totalScore();
+
+	mKernel.fieldWidth = mFieldWidth;
+	mKernel.fieldHeight = mFieldHeight;
+	mKernel.halfUnit = mHalfUnit;
+	mKernel.playerHeight = mPlayerHeight;
+	mKernel.player1X = mPlayer1X;
+	mKernel.player2X = mPlayer2X;
+	mKernel.minSpeed = mMinSpeed;
+	mKernel.maxSpeed = mMaxSpeed;
+
+	mSeed = DkRandom::randomSeed();
+	resize(numMatches);
+}
+
+void DkBatchEngine::resize(int numMatches) {
+
+	mState.resize(numMatches);
+	mEvents.resize(mState.size());
+	reset();
+}
+
+int DkBatchEngine::size() const {
+	return mState.size();
+}
+
+void DkBatchEngine::reset() {
+
+	DkBatchState& s = mState;
+
+	for (int idx = 0; idx < s.size(); idx++) {
+
+		s.score1[idx] = 0;
+		s.score2[idx] = 0;
+		s.wins1[idx] = 0;
+		s.wins2[idx] = 0;
+		s.player1Speed[idx] = 0.0f;
+		s.player2Speed[idx] = 0.0f;
+
+		s.seed[idx] = DkRandom::matchSeed(mSeed, idx);
+		s.random[idx].setSeed(s.seed[idx]);
+
+		initRally(idx, 0);
+
+		// random start direction (see DkEngineBall::randomDirection)
+		float dx = s.random[idx].uniform()*10.0f-5.0f;
+		float dy = s.random[idx].uniform()*5.0f-2.5f;
+		float n = std::sqrt(dx*dx + dy*dy);
+
+		if (n > 0.0f) {
+			s.dirX[idx] = dx / n;
+			s.dirY[idx] = dy / n;
+		}
+		clampAngle(idx);
+	}
+
+	mPoints = 0;
+	mGames = 0;
+}
+
+void DkBatchEngine::setSeed(quint64 seed) {
+	mSeed = seed;
+	reset();
+}
+
+quint64 DkBatchEngine::seed() const {
+	return mSeed;
+}
+
+void DkBatchEngine::setBots(bool bots) {
+	mBots = bots;
+}
+
+DkBatchState& DkBatchEngine::state() {
+	return mState;
+}
+
+const DkBatchState& DkBatchEngine::state() const {
+	return mState;
+}
+
+const DkBallKernelParams& DkBatchEngine::kernelParams() const {
+	return mKernel;
+}
+
+quint64 DkBatchEngine::points() const {
+	return mPoints;
+}
+
+quint64 DkBatchEngine::games() const {
+	return mGames;
+}
+
+void DkBatchEngine::run(quint64 ticks) {
+
+	for (quint64 idx = 0; idx < ticks; idx++)
+		step();
+}
+
+void DkBatchEngine::step() {
+
+	DkBatchState& s = mState;
+	const int n = s.size();
+
+	if (mBots) {
+		for (int idx = 0; idx < n; idx++)
+			botControl(idx);
+	}
+
+	// move all balls at once - hits & points are resolved below
+	DkBallKernel::step(mKernel, s, 0, n, mEvents.data());
+
+	const float maxTop = mFieldHeight - mPlayerHeight;
+
+	for (int idx = 0; idx < n; idx++) {
+
+		switch (mEvents[idx]) {
+		case ball_hit_player1:
+		case ball_hit_player2: {
+			float spd = qBound(mMinSpeed, s.speed[idx], mMaxSpeed);
+			bounce(idx, mEvents[idx] == ball_hit_player1 ? s.player1Velocity[idx] : s.player2Velocity[idx]);
+			s.ballX[idx] += s.dirX[idx] * spd;
+			s.ballY[idx] += s.dirY[idx] * spd;
+			s.rally[idx]++;
+			break;
+		}
+		case ball_out_left:
+			s.score2[idx]++;
+			initRally(idx, 2);
+			continue;
+		case ball_out_right:
+			s.score1[idx]++;
+			initRally(idx, 1);
+			continue;
+		default:
+			break;
+		}
+
+		// move players (see DkEnginePlayer::move)
+		float oldTop = s.player1Top[idx];
+		float top = qBound(0.0f, oldTop + s.player1Speed[idx], maxTop);
+		s.player1Top[idx] = top;
+		s.player1Velocity[idx] = oldTop - top;
+
+		oldTop = s.player2Top[idx];
+		top = qBound(0.0f, oldTop + s.player2Speed[idx], maxTop);
+		s.player2Top[idx] = top;
+		s.player2Velocity[idx] = oldTop - top;
+	}
+}
+
+void DkBatchEngine::initRally(int idx, int scorer) {
+
+	DkBatchState& s = mState;
+
+	s.ballX[idx] = (float)qRound(mFieldWidth*0.5f);
+	s.ballY[idx] = (float)qRound(mFieldHeight*0.5f);
+	s.speed[idx] = mStartSpeed;
+	s.rally[idx] = 0;
+
+	// the ball starts towards the player that scored
+	if (scorer != 0) {
+
+		float pc = (scorer == 1 ? s.player1Top[idx] : s.player2Top[idx]) + mPlayerHeight*0.5f;
+		float dx = (scorer == 1 ? mPlayer1X : mPlayer2X) - mFieldWidth*0.5f;
+		float dy = pc - mFieldHeight*0.5f;
+		float n = std::sqrt(dx*dx + dy*dy);
+
+		s.dirX[idx] = dx / n;
+		s.dirY[idx] = dy / n;
+		clampAngle(idx);
+
+		mPoints++;
+	}
+
+	float top = (float)qRound(mFieldHeight*0.5f - mPlayerHeight*0.5f);
+	s.player1Top[idx] = top;
+	s.player2Top[idx] = top;
+	s.player1Velocity[idx] = 0.0f;
+	s.player2Velocity[idx] = 0.0f;
+
+	// check if somebody won
+	if (s.score1[idx] >= mTotalScore || s.score2[idx] >= mTotalScore) {
+
+		if (s.score1[idx] > s.score2[idx])
+			s.wins1[idx]++;
+		else
+			s.wins2[idx]++;
+
+		s.score1[idx] = 0;
+		s.score2[idx] = 0;
+		mGames++;
+	}
+}
+
+void DkBatchEngine::bounce(int idx, float velocity) {
+
+	DkBatchState& s = mState;
+
+	float dx = s.dirX[idx];
+	float dy = s.dirY[idx];
+
+	// if the player moves in the ball direction slow it down
+	if (velocity*dy > 0.0f)
+		s.speed[idx] *= 0.8f;
+	else if (velocity*dy < 0.0f)
+		s.speed[idx] *= 1.2f;
+
+	// mirror at the player & add some magic (see DkEngineBall::changeDirPlayer)
+	float magic = s.random[idx].uniform() * 0.5f - 0.25f;
+	dx = -dx;
+
+	float c = std::cos(magic);
+	float sn = std::sin(magic);
+	float rx = dx*c + dy*sn;
+	float ry = -dx*sn + dy*c;
+
+	// change the angle if the ball does not become horizontal
+	bool horizontal = ((rx > 0.0f && ry > 0.0f) || (rx < 0.0f && ry < 0.0f)) && std::abs(ry) <= kHorizontalSlope*std::abs(rx);
+
+	if (!horizontal) {
+		c = 0.82533561f;	// cos(0.6)
+		sn = 0.56464247f;	// sin(0.6)
+		dx = rx;
+		rx = dx*c + ry*sn;
+		ry = -dx*sn + ry*c;
+	}
+
+	s.dirX[idx] = rx;
+	s.dirY[idx] = ry;
+	clampAngle(idx);
+}
+
+void DkBatchEngine::clampAngle(int idx) {
+
+	float dx = mState.dirX[idx];
+	float dy = mState.dirY[idx];
+
+	if (std::abs(dy) > kMaxSlope*std::abs(dx)) {
+		mState.dirX[idx] = std::copysign(kClampCos, dx);
+		mState.dirY[idx] = std::copysign(kClampSin, dy);
+	}
+}
+
+void DkBatchEngine::botControl(int idx) {
+
+	DkBatchState& s = mState;
+
+	float ps = mPlayerSpeed;
+	float y = s.ballY[idx];
+	float dy1 = y - (s.player1Top[idx] + mPlayerHeight*0.5f);
+	float dy2 = y - (s.player2Top[idx] + mPlayerHeight*0.5f);
+
+	s.player1Speed[idx] = dy1 > ps ? ps : (dy1 < -ps ? -ps : 0.0f);
+	s.player2Speed[idx] = dy2 > ps ? ps : (dy2 < -ps ? -ps : 0.0f);
+}
+
+}
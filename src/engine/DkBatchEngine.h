@@ -0,0 +1,168 @@
+/*******************************************************************************************************
+
+ DkBatchEngine.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QtGlobal>
+#include <vector>
+#pragma warning(pop)		// no warnings from includes - end
+
+#include "DkPongEngine.h"
+#include "DkBallKernel.h"
+#pragma warning(disable: 4251)
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+namespace pong {
+
+/**
+ * Structure of arrays that holds the state of N matches.
+ * Index i of each array belongs to match i.
+ **/
+struct DllExport DkBatchState {
+
+	void resize(int numMatches);
+	int size() const;
+
+	// ball
+	std::vector<float> ballX;		// ball center
+	std::vector<float> ballY;
+	std::vector<float> dirX;		// normalized direction
+	std::vector<float> dirY;
+	std::vector<float> speed;		// pixel per tick
+
+	// paddles (x, width and height are the same for all matches)
+	std::vector<float> player1Top;
+	std::vector<float> player2Top;
+	std::vector<float> player1Velocity;
+	std::vector<float> player2Velocity;
+	std::vector<float> player1Speed;	// input: paddle speed of the next tick
+	std::vector<float> player2Speed;
+
+	// match
+	std::vector<int> score1;
+	std::vector<int> score2;
+	std::vector<int> rally;
+	std::vector<int> wins1;
+	std::vector<int> wins2;
+
+	// random generators (one per match, no shared state)
+	std::vector<DkRandom> random;
+	std::vector<quint64> seed;
+};
+
+/**
+ * Simulates many matches at once.
+ * The rules are the same as DkEngineBall::move and DkEnginePlayer::move,
+ * but positions are kept with sub-pixel precision and the direction is
+ * kept normalized so that the common path needs no trigonometry.
+ * The balls are advanced by the (vectorized) DkBallKernel.
+ **/
+class DllExport DkBatchEngine {
+
+public:
+	DkBatchEngine(const DkEngineSettings& settings = DkEngineSettings(), int numMatches = 0);
+
+	void resize(int numMatches);
+	int size() const;
+
+	/**
+	 * Resets scores and rallies of all matches.
+	 **/
+	void reset();
+
+	/**
+	 * Sets the base seed and resets all matches.
+	 * Match i is seeded with DkRandom::matchSeed(seed, i).
+	 * @param seed the base seed.
+	 **/
+	void setSeed(quint64 seed);
+	quint64 seed() const;
+
+	/**
+	 * Advances all matches by one tick.
+	 **/
+	void step();
+
+	/**
+	 * Advances all matches by the given number of ticks.
+	 * @param ticks the number of ticks.
+	 **/
+	void run(quint64 ticks);
+
+	/**
+	 * If enabled, the paddles of each match follow their ball (like pong-sim bots).
+	 * Otherwise, player1Speed and player2Speed are used as inputs.
+	 **/
+	void setBots(bool bots);
+
+	DkBatchState& state();
+	const DkBatchState& state() const;
+	const DkBallKernelParams& kernelParams() const;
+
+	quint64 points() const;
+	quint64 games() const;
+
+protected:
+	DkBatchState mState;
+	bool mBots = true;
+	quint64 mSeed = 0;
+
+	// derived from the settings
+	float mFieldWidth = 0.0f;
+	float mFieldHeight = 0.0f;
+	float mHalfUnit = 0.0f;
+	float mPlayerHeight = 0.0f;
+	float mPlayer1X = 0.0f;		// paddle center x
+	float mPlayer2X = 0.0f;
+	float mPlayerSpeed = 0.0f;
+	float mMinSpeed = 0.0f;
+	float mMaxSpeed = 0.0f;
+	float mStartSpeed = 0.0f;
+	int mTotalScore = 10;
+
+	quint64 mPoints = 0;
+	quint64 mGames = 0;
+
+	DkBallKernelParams mKernel;
+	std::vector<quint8> mEvents;
+
+	void initRally(int idx, int scorer);
+	void bounce(int idx, float velocity);
+	void clampAngle(int idx);
+	void botControl(int idx);
+};
+
+}
@@ -0,0 +1,97 @@
+/*******************************************************************************************************
+
+ DkFixedStep.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#include "DkFixedStep.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <climits>
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+// DkFixedStep --------------------------------------------------------------------
+DkFixedStep::DkFixedStep(qint64 stepNs, int maxSteps) {
+
+	mStepNs = qMax(stepNs, (qint64)1);
+	mMaxSteps = qMax(maxSteps, 1);
+}
+
+void DkFixedStep::reset(qint64 nowNs) {
+
+	mLastNs = nowNs;
+	mAccumulator = 0;
+}
+
+int DkFixedStep::advance(qint64 nowNs) {
+
+	if (mLastNs < 0)
+		reset(nowNs);
+
+	qint64 dt = nowNs - mLastNs;
+	mLastNs = nowNs;
+
+	// the clock is monotonic - but better be safe
+	if (dt > 0)
+		mAccumulator += dt;
+
+	int steps = (int)qMin(mAccumulator / mStepNs, (qint64)INT_MAX);
+	mAccumulator -= steps * mStepNs;
+
+	// we are too far behind (e.g. the GUI thread stalled) - drop ticks instead of fast-forwarding
+	if (steps > mMaxSteps) {
+		mDroppedTicks += steps - mMaxSteps;
+		steps = mMaxSteps;
+	}
+
+	if (steps > 1)
+		mCaughtUpTicks += steps - 1;
+
+	mTicks += steps;
+
+	return steps;
+}
+
+double DkFixedStep::alpha() const {
+	return (double)mAccumulator / mStepNs;
+}
+
+qint64 DkFixedStep::stepNs() const {
+	return mStepNs;
+}
+
+quint64 DkFixedStep::ticks() const {
+	return mTicks;
+}
+
+quint64 DkFixedStep::droppedTicks() const {
+	return mDroppedTicks;
+}
+
+quint64 DkFixedStep::caughtUpTicks() const {
+	return mCaughtUpTicks;
+}
+
+}
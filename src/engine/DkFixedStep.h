@@ -0,0 +1,97 @@
+/*******************************************************************************************************
+
+ DkFixedStep.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QtGlobal>
+#pragma warning(pop)		// no warnings from includes - end
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+namespace pong {
+
+/**
+ * Accumulator for a fixed simulation timestep.
+ * The caller feeds a monotonic clock and runs the returned
+ * number of ticks. The remaining time is used to interpolate
+ * between the previous and the current game state.
+ **/
+class DllExport DkFixedStep {
+
+public:
+	/**
+	 * @param stepNs the simulation step in nano seconds (default: 10 ms = 100 Hz).
+	 * @param maxSteps the maximum number of ticks that are caught up per call.
+	 **/
+	DkFixedStep(qint64 stepNs = 10000000, int maxSteps = 5);
+
+	/**
+	 * Restarts the accumulator (e.g. after a pause).
+	 * @param nowNs the current time of the monotonic clock.
+	 **/
+	void reset(qint64 nowNs);
+
+	/**
+	 * Accumulates the time that passed since the last call.
+	 * @param nowNs the current time of the monotonic clock.
+	 * @return the number of ticks that need to be simulated.
+	 **/
+	int advance(qint64 nowNs);
+
+	/**
+	 * Returns the interpolation factor between the previous and the current tick.
+	 * @return the factor in [0 1).
+	 **/
+	double alpha() const;
+
+	qint64 stepNs() const;
+
+	quint64 ticks() const;
+	quint64 droppedTicks() const;
+	quint64 caughtUpTicks() const;
+
+protected:
+	qint64 mStepNs = 10000000;
+	int mMaxSteps = 5;
+
+	qint64 mLastNs = -1;
+	qint64 mAccumulator = 0;
+
+	quint64 mTicks = 0;
+	quint64 mDroppedTicks = 0;		// ticks that were skipped since we fell too far behind
+	quint64 mCaughtUpTicks = 0;		// additional ticks that were run within a single frame
+};
+
+}
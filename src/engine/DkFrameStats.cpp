@@ -0,0 +1,134 @@
+/*******************************************************************************************************
+
+ DkFrameStats.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#include "DkFrameStats.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <algorithm>
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+// DkFrameStats --------------------------------------------------------------------
+void DkFrameStats::addFrame(qint64 startNs, qint64 loopNs, int ticks) {
+
+	DkFrameRecord& r = mRecords[mHead];
+	r.startNs = startNs;
+	r.intervalNs = mLastStartNs >= 0 ? startNs - mLastStartNs : 0;
+	r.loopNs = loopNs;
+	r.paintNs = 0;
+	r.ticks = ticks;
+
+	mLastStartNs = startNs;
+	mHead = (mHead + 1) % num_records;
+	mSize = qMin(mSize + 1, (int)num_records);
+}
+
+void DkFrameStats::addPaint(qint64 ns) {
+
+	if (mSize == 0)
+		return;
+
+	// several paint events per frame are summed up
+	mRecords[(mHead + num_records - 1) % num_records].paintNs += ns;
+}
+
+void DkFrameStats::breakInterval() {
+	mLastStartNs = -1;
+}
+
+void DkFrameStats::clear() {
+
+	mHead = 0;
+	mSize = 0;
+	mLastStartNs = -1;
+}
+
+int DkFrameStats::size() const {
+	return mSize;
+}
+
+const DkFrameRecord& DkFrameStats::record(int idx) const {
+	return mRecords[(mHead - mSize + idx + num_records) % num_records];
+}
+
+DkFrameStats::Summary DkFrameStats::summary(Timing timing) const {
+
+	// copy to the stack (this is called a few times per second only)
+	qint64 values[num_records];
+	int n = 0;
+
+	for (int idx = 0; idx < mSize; idx++) {
+
+		const DkFrameRecord& r = record(idx);
+		qint64 v = timing == timing_loop ? r.loopNs : timing == timing_paint ? r.paintNs : r.intervalNs;
+
+		// not painted or no interval
+		if (timing != timing_loop && v <= 0)
+			continue;
+
+		values[n++] = v;
+	}
+
+	Summary s;
+	s.count = n;
+
+	if (n == 0)
+		return s;
+
+	int i50 = (n - 1) * 50 / 100;
+	int i99 = (n - 1) * 99 / 100;
+
+	std::nth_element(values, values + i99, values + n);
+	s.p99 = values[i99] / 1e6;
+	s.max = *std::max_element(values + i99, values + n) / 1e6;
+
+	std::nth_element(values, values + i50, values + i99);
+	s.p50 = values[i50] / 1e6;
+
+	return s;
+}
+
+double DkFrameStats::tickRate() const {
+
+	qint64 ticks = 0;
+	qint64 dt = 0;
+
+	// the ticks of a frame were due during its interval (pauses are not counted)
+	for (int idx = 0; idx < mSize; idx++) {
+
+		const DkFrameRecord& r = record(idx);
+
+		if (r.intervalNs > 0) {
+			ticks += r.ticks;
+			dt += r.intervalNs;
+		}
+	}
+
+	return dt > 0 ? ticks * 1e9 / dt : 0.0;
+}
+
+}
@@ -0,0 +1,124 @@
+/*******************************************************************************************************
+
+ DkFrameStats.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QtGlobal>
+#pragma warning(pop)		// no warnings from includes - end
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+namespace pong {
+
+/**
+ * Timing of a frame (one game loop iteration).
+ **/
+struct DllExport DkFrameRecord {
+
+	qint64 startNs = 0;		// when the game loop started
+	qint64 intervalNs = 0;	// since the previous frame (0: unknown, e.g. after a pause)
+	qint64 loopNs = 0;		// game loop (ticks)
+	qint64 paintNs = 0;		// paintEvent (0: not painted)
+	int ticks = 0;
+};
+
+/**
+ * Rolling window of the last frames' timing.
+ * The records are kept in a fixed ring buffer - nothing is allocated per frame.
+ **/
+class DllExport DkFrameStats {
+
+public:
+	enum {
+		num_records = 512	// ~8 s at 60 Hz
+	};
+
+	enum Timing {
+		timing_loop = 0,
+		timing_paint,
+		timing_interval,
+
+		timing_end
+	};
+
+	/**
+	 * Percentiles of a timing over the window (in ms).
+	 **/
+	struct DllExport Summary {
+		double p50 = 0.0;
+		double p99 = 0.0;
+		double max = 0.0;
+		int count = 0;
+	};
+
+	DkFrameStats() {};
+
+	/**
+	 * Adds a frame.
+	 * @param startNs when the game loop started (monotonic clock).
+	 * @param loopNs how long the game loop took.
+	 * @param ticks the number of ticks that were simulated.
+	 **/
+	void addFrame(qint64 startNs, qint64 loopNs, int ticks);
+
+	/**
+	 * Adds the paint time to the newest frame.
+	 **/
+	void addPaint(qint64 ns);
+
+	/**
+	 * The next frame does not measure the interval (e.g. the game was paused).
+	 **/
+	void breakInterval();
+	void clear();
+
+	int size() const;
+	const DkFrameRecord& record(int idx) const;	// 0 is the oldest
+
+	Summary summary(Timing timing) const;
+
+	/**
+	 * Returns the simulated ticks per second of the window.
+	 **/
+	double tickRate() const;
+
+protected:
+	DkFrameRecord mRecords[num_records];
+	int mHead = 0;		// the next record
+	int mSize = 0;
+	qint64 mLastStartNs = -1;
+};
+
+}
@@ -0,0 +1,107 @@
+/*******************************************************************************************************
+
+ DkInputFilter.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+
+#include "DkInputFilter.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <cmath>
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+// DkInputFilter --------------------------------------------------------------------
+DkInputFilter::DkInputFilter(float minCutoff, float beta, float dCutoff, float minSpeed) {
+
+	mMinCutoff = minCutoff;
+	mBeta = beta;
+	mDCutoff = dCutoff;
+	mMinSpeed = minSpeed;
+}
+
+void DkInputFilter::reset() {
+
+	mValid = false;
+	mRaw = 0.0f;
+	mValue = 0.0f;
+	mVelocity = 0.0f;
+	mLag = 0.0f;
+}
+
+bool DkInputFilter::isValid() const {
+	return mValid;
+}
+
+float DkInputFilter::filter(float value, float dt) {
+
+	if (!mValid || dt <= 0.0f) {
+		mRaw = value;
+		mValue = value;
+		mVelocity = 0.0f;
+		mLag = 0.0f;
+		mValid = true;
+		return mValue;
+	}
+
+	// filter the derivative first - it controls the cutoff of the value
+	float dx = (value - mRaw) / dt;
+	mVelocity += smoothing(mDCutoff, dt) * (dx - mVelocity);
+
+	float cutoff = mMinCutoff + mBeta * std::abs(mVelocity);
+	float a = smoothing(cutoff, dt);
+	mValue += a * (value - mValue);
+	mRaw = value;
+
+	// an exponential smoother lags (1-a)/a samples behind a ramp
+	mLag = dt * (1.0f - a) / a;
+
+	return mValue;
+}
+
+float DkInputFilter::value() const {
+	return mValue;
+}
+
+float DkInputFilter::velocity() const {
+	return mVelocity;
+}
+
+float DkInputFilter::predict(float lead) const {
+
+	// the velocity of a resting paddle is noise - extrapolating it would bring back the jitter
+	float speed = std::abs(mVelocity);
+	float weight = speed / (speed + mMinSpeed);
+
+	return mValue + mVelocity * (mLag + lead) * weight;
+}
+
+float DkInputFilter::smoothing(float cutoff, float dt) {
+
+	float tau = 1.0f / (2.0f * 3.14159265f * cutoff);
+	return 1.0f / (1.0f + tau / dt);
+}
+
+}
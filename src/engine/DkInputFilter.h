@@ -0,0 +1,103 @@
+/*******************************************************************************************************
+
+ DkInputFilter.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QtGlobal>
+#pragma warning(pop)		// no warnings from includes - end
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+namespace pong {
+
+/**
+ * One euro filter (Casiez et al. 2012) for the analogue paddles.
+ * The cutoff frequency rises with the paddle's speed: a resting paddle
+ * is smoothed heavily (no jitter) while a fast paddle barely lags.
+ * The velocity is a low-pass filtered derivative of all samples and
+ * is used to compensate the remaining lag (see predict()).
+ * Values are normalized (e.g. controller positions in [0 1]).
+ **/
+class DllExport DkInputFilter {
+
+public:
+	/**
+	 * @param minCutoff the cutoff frequency (Hz) of a resting paddle.
+	 * @param beta the cutoff increase per unit of speed (units/sec).
+	 * @param dCutoff the cutoff frequency (Hz) of the velocity.
+	 * @param minSpeed predictions fade out below this speed (units/sec) - slower motion is mostly noise.
+	 **/
+	DkInputFilter(float minCutoff = 1.0f, float beta = 30.0f, float dCutoff = 3.0f, float minSpeed = 0.3f);
+
+	void reset();
+	bool isValid() const;
+
+	/**
+	 * Adds a sample.
+	 * @param value the raw value.
+	 * @param dt the time since the last sample in seconds.
+	 * @return the filtered value.
+	 **/
+	float filter(float value, float dt);
+
+	float value() const;
+	float velocity() const;
+
+	/**
+	 * Extrapolates the filtered value by its lag and lead seconds.
+	 * For a paddle that moves with constant speed and lead = 0
+	 * this is the newest sample without noise.
+	 * @param lead the time (seconds) from the newest sample to the prediction.
+	 * @return the predicted value.
+	 **/
+	float predict(float lead = 0.0f) const;
+
+protected:
+	float mMinCutoff = 1.0f;
+	float mBeta = 30.0f;
+	float mDCutoff = 3.0f;
+	float mMinSpeed = 0.3f;
+
+	bool mValid = false;
+	float mRaw = 0.0f;
+	float mValue = 0.0f;
+	float mVelocity = 0.0f;
+	float mLag = 0.0f;
+
+	static float smoothing(float cutoff, float dt);
+};
+
+}
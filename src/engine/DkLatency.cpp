@@ -0,0 +1,181 @@
+/*******************************************************************************************************
+
+ DkLatency.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#include "DkLatency.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+#include <chrono>
+#include <cmath>
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+// DkLatencyHistogram --------------------------------------------------------------------
+void DkLatencyHistogram::add(qint64 ns) {
+
+	ns = qMax(ns, (qint64)0);
+
+	int idx = 0;
+	double us = ns / 1000.0;
+
+	if (us > 1.0)
+		idx = qMin((int)std::ceil(std::log2(us)*buckets_per_octave), num_buckets-1);
+
+	mBuckets[idx]++;
+	mCount++;
+	mSumNs += ns;
+	mMaxNs = qMax(mMaxNs, ns);
+}
+
+void DkLatencyHistogram::clear() {
+
+	for (int idx = 0; idx < num_buckets; idx++)
+		mBuckets[idx] = 0;
+
+	mCount = 0;
+	mSumNs = 0;
+	mMaxNs = 0;
+}
+
+quint64 DkLatencyHistogram::count() const {
+	return mCount;
+}
+
+double DkLatencyHistogram::mean() const {
+	return mCount ? mSumNs / 1000.0 / mCount : 0.0;
+}
+
+double DkLatencyHistogram::max() const {
+	return mMaxNs / 1000.0;
+}
+
+double DkLatencyHistogram::bucketLimit(int idx) {
+	return std::pow(2.0, (double)idx / buckets_per_octave);
+}
+
+quint64 DkLatencyHistogram::bucketCount(int idx) const {
+	return mBuckets[idx];
+}
+
+double DkLatencyHistogram::percentile(double p) const {
+
+	if (!mCount)
+		return 0.0;
+
+	quint64 rank = (quint64)std::ceil(qBound(0.0, p, 1.0) * mCount);
+	quint64 sum = 0;
+
+	for (int idx = 0; idx < num_buckets; idx++) {
+
+		sum += mBuckets[idx];
+
+		// the bucket limit might be larger than the max value
+		if (sum >= rank && sum > 0)
+			return qMin(bucketLimit(idx), max());
+	}
+
+	return max();
+}
+
+// DkLatency --------------------------------------------------------------------
+qint64 DkLatency::now() {
+
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QString DkLatency::stageName(Stage stage) {
+
+	switch (stage) {
+	case stage_read_dispatch:	return "read->dispatch";
+	case stage_dispatch_sim:	return "dispatch->sim";
+	case stage_sim_paint:		return "sim->paint";
+	default:					return "unknown";
+	}
+}
+
+void DkLatency::add(Stage stage, qint64 ns) {
+	mHistograms[stage].add(ns);
+}
+
+const DkLatencyHistogram& DkLatency::histogram(Stage stage) const {
+	return mHistograms[stage];
+}
+
+QString DkLatency::summary() const {
+
+	QString str;
+	QTextStream ts(&str);
+
+	for (int sIdx = 0; sIdx < stage_end; sIdx++) {
+
+		const DkLatencyHistogram& h = mHistograms[sIdx];
+		ts << stageName((Stage)sIdx) << ": " << h.count() << " samples"
+			<< ", p50 " << h.percentile(0.5) << " us"
+			<< ", p99 " << h.percentile(0.99) << " us"
+			<< ", max " << h.max() << " us\n";
+	}
+
+	return str;
+}
+
+bool DkLatency::save(const QString& filePath) const {
+
+	QFile file(filePath);
+
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+		qWarning() << "cannot write latency histograms to" << filePath;
+		return false;
+	}
+
+	QTextStream ts(&file);
+
+	ts << "stage,count,mean_us,p50_us,p90_us,p99_us,max_us\n";
+	for (int sIdx = 0; sIdx < stage_end; sIdx++) {
+
+		const DkLatencyHistogram& h = mHistograms[sIdx];
+		ts << stageName((Stage)sIdx) << "," << h.count() << "," << h.mean() << ","
+			<< h.percentile(0.5) << "," << h.percentile(0.9) << "," << h.percentile(0.99) << "," << h.max() << "\n";
+	}
+
+	ts << "\nstage,bucket_us,count\n";
+	for (int sIdx = 0; sIdx < stage_end; sIdx++) {
+
+		const DkLatencyHistogram& h = mHistograms[sIdx];
+
+		for (int idx = 0; idx < DkLatencyHistogram::num_buckets; idx++) {
+			if (h.bucketCount(idx))
+				ts << stageName((Stage)sIdx) << "," << DkLatencyHistogram::bucketLimit(idx) << "," << h.bucketCount(idx) << "\n";
+		}
+	}
+
+	return true;
+}
+
+}
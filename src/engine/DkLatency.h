@@ -0,0 +1,130 @@
+/*******************************************************************************************************
+
+ DkLatency.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QtGlobal>
+#include <QString>
+#pragma warning(pop)		// no warnings from includes - end
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+namespace pong {
+
+/**
+ * Log-scale histogram of durations (4 buckets per octave from 1 us to ~16 s).
+ * It has a fixed size and never allocates - so it can be used in the game loop.
+ **/
+class DllExport DkLatencyHistogram {
+
+public:
+	enum {
+		buckets_per_octave = 4,
+		num_buckets = 1 + 24*buckets_per_octave
+	};
+
+	DkLatencyHistogram() {};
+
+	void add(qint64 ns);
+	void clear();
+
+	quint64 count() const;
+	double mean() const;	// in us
+	double max() const;		// in us
+
+	/**
+	 * Returns the upper bound of the bucket that contains the percentile.
+	 * @param p the percentile in [0 1].
+	 * @return the duration in us.
+	 **/
+	double percentile(double p) const;
+
+	/**
+	 * Returns the upper bound of a bucket.
+	 * @return the duration in us.
+	 **/
+	static double bucketLimit(int idx);
+	quint64 bucketCount(int idx) const;
+
+protected:
+	quint64 mBuckets[num_buckets] = {};
+	quint64 mCount = 0;
+	qint64 mSumNs = 0;
+	qint64 mMaxNs = 0;
+};
+
+/**
+ * Latency of controller samples from the serial port to the screen.
+ * Each sample is stamped when it is read. Then, we measure how long it takes
+ * until it is dispatched (controllerUpdate), simulated (the paddle moves)
+ * and painted (the first paintEvent that shows the paddle's tick).
+ **/
+class DllExport DkLatency {
+
+public:
+	enum Stage {
+		stage_read_dispatch = 0,
+		stage_dispatch_sim,
+		stage_sim_paint,
+
+		stage_end
+	};
+
+	DkLatency() {};
+
+	/**
+	 * Returns the monotonic clock that is shared by all threads.
+	 * @return the time in ns.
+	 **/
+	static qint64 now();
+	static QString stageName(Stage stage);
+
+	void add(Stage stage, qint64 ns);
+	const DkLatencyHistogram& histogram(Stage stage) const;
+
+	QString summary() const;
+
+	/**
+	 * Writes all histograms as CSV (summary & buckets).
+	 * @param filePath the CSV file.
+	 * @return true if the file was written.
+	 **/
+	bool save(const QString& filePath) const;
+
+protected:
+	DkLatencyHistogram mHistograms[stage_end];
+};
+
+}
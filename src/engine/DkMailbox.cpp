@@ -0,0 +1,113 @@
+/*******************************************************************************************************
+
+ DkMailbox.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#include "DkMailbox.h"
+
+namespace pong {
+
+// DkMailbox --------------------------------------------------------------------
+DkMailbox::DkMailbox() {
+
+	for (int idx = 0; idx < max_pins; idx++) {
+		mValues[idx].store(0, std::memory_order_relaxed);
+		mStamps[idx].store(0, std::memory_order_relaxed);
+		mSeq[idx].store(0, std::memory_order_relaxed);
+	}
+
+	mDirty.store(0);
+	mPosted.store(0);
+	mTaken.store(0);
+}
+
+bool DkMailbox::post(int pin, int value, qint64 stamp) {
+
+	if (pin < 0 || pin >= max_pins)
+		return false;
+
+	// there is only one writer - it owns the sequence number
+	quint32 seq = mSeq[pin].load(std::memory_order_relaxed);
+	mSeq[pin].store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	mValues[pin].store(value, std::memory_order_relaxed);
+	mStamps[pin].store(stamp, std::memory_order_relaxed);
+
+	mSeq[pin].store(seq + 2, std::memory_order_release);
+	mPosted.fetch_add(1, std::memory_order_relaxed);
+
+	// the value is visible before the dirty bit
+	// seq_cst: a writer that finds the mailbox non-empty is sure the reader takes its value
+	quint64 old = mDirty.fetch_or(1ull << pin);
+
+	return old == 0;
+}
+
+quint64 DkMailbox::take(int* values, qint64* stamps) {
+
+	// pairs with the fetch_or in post
+	quint64 mask = mDirty.exchange(0);
+
+	// a value posted after the exchange sets its bit again - it is delivered (again) next time
+	for (quint64 m = mask; m; m &= m - 1) {
+
+		int pin = 0;
+		while (!(m & (1ull << pin)))
+			pin++;
+
+		int value;
+		qint64 stamp;
+		quint32 seq;
+
+		// retry if the writer updated the pin while we read it
+		do {
+			seq = mSeq[pin].load(std::memory_order_acquire);
+			value = mValues[pin].load(std::memory_order_relaxed);
+			stamp = mStamps[pin].load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+		} while ((seq & 1) || seq != mSeq[pin].load(std::memory_order_relaxed));
+
+		values[pin] = value;
+		if (stamps)
+			stamps[pin] = stamp;
+		mTaken.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return mask;
+}
+
+bool DkMailbox::isEmpty() const {
+	return mDirty.load(std::memory_order_relaxed) == 0;
+}
+
+quint64 DkMailbox::posted() const {
+	return mPosted.load(std::memory_order_relaxed);
+}
+
+quint64 DkMailbox::taken() const {
+	return mTaken.load(std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,96 @@
+/*******************************************************************************************************
+
+ DkMailbox.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QtGlobal>
+#include <atomic>
+#pragma warning(pop)		// no warnings from includes - end
+
+#pragma warning(disable: 4251)
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+namespace pong {
+
+/**
+ * Lock-free latest-value mailbox with one slot per controller pin.
+ * One thread posts values, another takes them (e.g. once per tick).
+ * Only the newest value per pin is kept, older ones are coalesced.
+ * Value and stamp of a pin are guarded by a sequence number (seqlock)
+ * so that the reader never gets a value with the stamp of another one.
+ **/
+class DllExport DkMailbox {
+
+public:
+	enum {
+		max_pins = 64
+	};
+
+	DkMailbox();
+
+	/**
+	 * Stores the newest value of a pin (writer thread).
+	 * @param pin the pin in [0 max_pins).
+	 * @param value the value.
+	 * @param stamp the time the value was read (see DkLatency::now).
+	 * @return true if the mailbox was empty before - the reader should be notified.
+	 **/
+	bool post(int pin, int value, qint64 stamp = 0);
+
+	/**
+	 * Takes all values that changed since the last call (reader thread).
+	 * @param values receives the newest value of each changed pin (max_pins entries).
+	 * @param stamps receives the time stamps of the values (max_pins entries, optional).
+	 * @return a mask with bit i set if pin i changed.
+	 **/
+	quint64 take(int* values, qint64* stamps = 0);
+
+	bool isEmpty() const;
+
+	quint64 posted() const;
+	quint64 taken() const;
+
+protected:
+	std::atomic<int> mValues[max_pins];
+	std::atomic<qint64> mStamps[max_pins];
+	std::atomic<quint32> mSeq[max_pins];	// odd while the writer updates a pin
+	std::atomic<quint64> mDirty;
+
+	std::atomic<quint64> mPosted;
+	std::atomic<quint64> mTaken;
+};
+
+}
@@ -0,0 +1,644 @@
+/*******************************************************************************************************
+
+ DkPongEngine.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#include "DkPongEngine.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+// DkEngineSettings --------------------------------------------------------------------
+void DkEngineSettings::setField(const QRect & field) {
+	mField = field;
+}
+
+QRect DkEngineSettings::field() const {
+	return mField;
+}
+
+void DkEngineSettings::setUnit(int unit) {
+	mUnit = unit;
+}
+
+int DkEngineSettings::unit() const {
+	return mUnit;
+}
+
+void DkEngineSettings::setTotalScore(int maxScore) {
+	mTotalScore = maxScore;
+}
+
+int DkEngineSettings::totalScore() const {
+	return mTotalScore;
+}
+
+void DkEngineSettings::setPlayerRatio(float ratio) {
+	mPlayerRatio = ratio;
+}
+
+float DkEngineSettings::playerRatio() const {
+	return mPlayerRatio;
+}
+
+void DkEngineSettings::setSpeed(float speed) {
+	mSpeed = speed;
+}
+
+float DkEngineSettings::speed() const {
+	return mSpeed;
+}
+
+void DkEngineSettings::setInputFilter(bool filter) {
+	mInputFilter = filter;
+}
+
+bool DkEngineSettings::inputFilter() const {
+	return mInputFilter;
+}
+
+const float DkEngineSettings::tick_seconds = 0.01f;
+
+// DkEnginePlayer --------------------------------------------------------------------
+DkEnginePlayer::DkEnginePlayer(QSharedPointer<DkEngineSettings> settings) {
+
+	mS = settings;
+	mSpeed = 0;
+	mPos = INT_MAX;
+	mRect = QRect(QPoint(), QSize(settings->unit(), 2*settings->unit()));
+}
+
+void DkEnginePlayer::reset(const QPoint& pos) {
+
+	// only reset if we don't have controller
+	if (mControllerPos == -1)
+		mRect.moveCenter(pos);
+}
+
+int DkEnginePlayer::pos() const {
+	return mPos;
+}
+
+QRect DkEnginePlayer::rect() const {
+	return mRect;
+}
+
+void DkEnginePlayer::setHeight(int newHeight) {
+	mRect.setHeight(newHeight);
+}
+
+int DkEnginePlayer::velocity() const {
+	return mVelocity;
+}
+
+DkPlayerState DkEnginePlayer::state() const {
+
+	DkPlayerState s;
+	s.top = mRect.top();
+	s.velocity = mVelocity;
+	s.speed = mSpeed;
+	s.controllerPos = mControllerPos;
+
+	return s;
+}
+
+void DkEnginePlayer::setState(const DkPlayerState& state) {
+
+	mRect.moveTop(state.top);
+	mVelocity = state.velocity;
+	mControllerPos = state.controllerPos;
+	setSpeed(state.speed);
+	resetFilter();
+}
+
+void DkEnginePlayer::resetFilter() {
+	mFilter.reset();
+}
+
+float DkEnginePlayer::velocityEstimate() const {
+
+	if (!mFilter.isValid())
+		return 0.0f;
+
+	// like mVelocity: a rising controller value moves the player up (positive velocity)
+	return mFilter.velocity() * DkEngineSettings::tick_seconds * (mS->field().height() - mRect.height());
+}
+
+void DkEnginePlayer::follow(const DkEngineBall& ball, int speed) {
+
+	int dy = ball.rect().center().y() - mRect.center().y();
+
+	if (dy > speed)
+		setSpeed(speed);
+	else if (dy < -speed)
+		setSpeed(-speed);
+	else
+		setSpeed(0);
+}
+
+int DkEnginePlayer::controllerTop(float pos) const {
+	return qRound((1-pos)*(mS->field().height()-mRect.height()));
+}
+
+void DkEnginePlayer::move() {
+
+	int oldTop = mRect.top();
+
+	// arduino controlls
+	if (mControllerPos != -1 && mS->inputFilter()) {
+		mFilter.filter(mControllerPos, DkEngineSettings::tick_seconds);
+
+		// the newest sample is half a tick old (on average) and the position is kept for the next tick
+		float pos = mFilter.predict(DkEngineSettings::tick_seconds);
+		mRect.moveTop(controllerTop(qBound(0.0f, pos, 1.0f)));
+		mVelocity = qRound(velocityEstimate());
+		return;
+	}
+	else if (mControllerPos != -1) {
+		mRect.moveTop(controllerTop(mControllerPos));
+		mVelocity = oldTop - mRect.top();
+		return;
+	}
+
+	if (mRect.top() + mSpeed < 0)
+		mRect.moveTop(0);
+	else if (mRect.bottom() + mSpeed > mS->field().height())
+		mRect.moveBottom(mS->field().height());
+	else
+		mRect.moveTop(mRect.top() + mSpeed);
+
+	mVelocity = oldTop - mRect.top();
+}
+
+void DkEnginePlayer::setSpeed(int speed) {
+
+	mSpeed = speed;
+
+	if (speed != 0)
+		mPos = mRect.center().y();
+	else
+		mPos = INT_MAX;
+}
+
+int DkEnginePlayer::speed() const {
+	return mSpeed;
+}
+
+void DkEnginePlayer::setPos(float pos) {
+
+	mControllerPos = pos;
+
+	// filtered controllers move once per tick (the filter needs a fixed timestep)
+	if (!mS->inputFilter())
+		move();
+}
+
+float DkEnginePlayer::controllerPos() const {
+	return mControllerPos;
+}
+
+void DkEnginePlayer::updateSize() {
+	mRect.setHeight(qRound(mS->field().height()*mS->playerRatio()));
+}
+
+void DkEnginePlayer::increaseScore() {
+	mScore++;
+}
+
+void DkEnginePlayer::resetScore() {
+	mScore = 0;
+}
+
+int DkEnginePlayer::score() const {
+	return mScore;
+}
+
+// DkEngineBall --------------------------------------------------------------------
+DkEngineBall::DkEngineBall(QSharedPointer<DkEngineSettings> settings) {
+
+	mS = settings;
+	mRandom.setSeed(DkRandom::randomSeed());
+
+	mMinSpeed = qRound(mS->field().width()*0.005);
+	mMaxSpeed = qRound(mS->field().width()*0.01);
+
+	mRect = QRect(QPoint(), QSize(mS->unit(), mS->unit()));
+
+	reset();
+}
+
+void DkEngineBall::reset() {
+
+	mRect.moveCenter(QPoint(qRound(mS->field().width()*0.5f), qRound(mS->field().height()*0.5f)));
+	mCenter = Vec2f(QPointF(mRect.center()));
+	mRally = 0;
+	mLastHit = 0;
+	setSpeed(mS->speed());
+}
+
+void DkEngineBall::updateSize() {
+	mMinSpeed = qRound(mS->field().width()*0.005);
+	mMaxSpeed = qRound(mS->field().width()*0.02);
+	setDirection(randomDirection());
+}
+
+void DkEngineBall::setSeed(quint64 seed) {
+	mRandom.setSeed(seed);
+	setDirection(randomDirection());
+}
+
+quint64 DkEngineBall::seed() const {
+	return mRandom.seed();
+}
+
+Vec2f DkEngineBall::randomDirection() {
+
+	float dx = mRandom.uniform()*10.0f-5.0f;
+	float dy = mRandom.uniform()*5.0f-2.5f;
+
+	return Vec2f(dx, dy);
+}
+
+QRect DkEngineBall::rect() const {
+	return mRect;
+}
+
+QPoint DkEngineBall::direction() const {
+	return mDirection.toQPointF().toPoint();
+}
+
+void DkEngineBall::setSpeed(float val) {
+	mSpeed = val;
+	mS->setSpeed(mSpeed);	// update settings speed
+
+	if (mSpeed < mMinSpeed)
+		mSpeed = (float)mMinSpeed;
+	if (mSpeed > mMaxSpeed)
+		mSpeed = (float)mMaxSpeed;
+}
+
+float DkEngineBall::speed() const {
+	return mSpeed;
+}
+
+void DkEngineBall::setAnalogueSpeed(float val) {
+
+	setSpeed(analogueSpeed(val));
+}
+
+float DkEngineBall::analogueSpeed(float val) const {
+	return val * (mMaxSpeed - mMinSpeed) + mMinSpeed;
+}
+
+const DkEnginePlayer* DkEngineBall::lastHit() const {
+	return mLastHit;
+}
+
+bool DkEngineBall::move(DkEnginePlayer* player1, DkEnginePlayer* player2) {
+	return moveBall<Vec2f>(player1, player2);
+}
+
+bool DkEngineBall::moveReference(DkEnginePlayer* player1, DkEnginePlayer* player2) {
+	return moveBall<DkVector>(player1, player2);
+}
+
+template <typename Vec>
+bool DkEngineBall::moveBall(DkEnginePlayer* player1, DkEnginePlayer* player2) {
+
+	mLastHit = 0;
+
+	// check minimum speed
+	if (mSpeed < mMinSpeed)
+		mSpeed = (float)mMinSpeed;
+
+	Vec dir(mDirection.x, mDirection.y);
+	Vec center(mCenter.x, mCenter.y);
+	dir.normalize();
+	dir *= mSpeed;
+	fixDirection(dir);
+
+	const QRect& f = mS->field();
+	float hs = mRect.width()*0.5f;
+
+	// resolve all collisions of this tick in the order they happen
+	// dir is the displacement of a whole tick, so times of impact are in [0 1]
+	float remaining = 1.0f;
+
+	for (int cIdx = 0; cIdx < max_collisions && remaining > 0.0f; cIdx++) {
+
+		float toi = remaining;
+		Collision c = collision_none;
+		float t;
+
+		// collision detection top & bottom
+		if (dir.y < 0 && (t = (f.top() + hs - center.y) / dir.y) < toi) {
+			toi = qMax(t, 0.0f);
+			c = collision_wall;
+		}
+		else if (dir.y > 0 && (t = (f.top() + f.height() - hs - center.y) / dir.y) < toi) {
+			toi = qMax(t, 0.0f);
+			c = collision_wall;
+		}
+
+		// collision detection left & right
+		if (dir.x < 0 && (t = (f.left() + hs - center.x) / dir.x) < toi) {
+			toi = qMax(t, 0.0f);
+			c = collision_left;
+		}
+		else if (dir.x > 0 && (t = (f.left() + f.width() - hs - center.x) / dir.x) < toi) {
+			toi = qMax(t, 0.0f);
+			c = collision_right;
+		}
+
+		// player collision (players win ties)
+		if (dir.x < 0 && sweep(player1->rect(), center, dir, t) && t <= toi) {
+			toi = t;
+			c = collision_player1;
+		}
+		else if (dir.x > 0 && sweep(player2->rect(), center, dir, t) && t <= toi) {
+			toi = t;
+			c = collision_player2;
+		}
+
+		center += dir * toi;
+		remaining -= toi;
+
+		switch (c) {
+		case collision_wall:
+			dir.y = -dir.y;
+			break;
+		case collision_player1:
+		case collision_player2: {
+			DkEnginePlayer* player = (c == collision_player1) ? player1 : player2;
+			mSpeed *= changeDirPlayer(player, dir);
+
+			// the rest of this tick is travelled with the new speed
+			dir.normalize();
+			dir *= mSpeed;
+			fixDirection(dir);
+
+			mLastHit = player;
+			mRally++;
+			break;
+		}
+		case collision_left:
+		case collision_right: {
+			DkEnginePlayer* scorer = (c == collision_left) ? player2 : player1;
+			dir = Vec(QPointF(scorer->rect().center())-f.center());
+			dir.normalize();
+			dir *= (float)mMinSpeed;
+			setDirection(Vec2f(dir.x, dir.y));
+			mCenter = Vec2f(center.x, center.y);
+			mRect.moveCenter(center.toQPointF().toPoint());
+			scorer->increaseScore();
+			return false;
+		}
+		default:
+			remaining = 0.0f;
+			break;
+		}
+	}
+
+	setDirection(Vec2f(dir.x, dir.y));
+	mCenter = Vec2f(center.x, center.y);
+	mRect.moveCenter(center.toQPointF().toPoint());
+
+	return true;
+}
+
+template <typename Vec>
+float DkEngineBall::changeDirPlayer(const DkEnginePlayer* player, Vec& dir) {
+
+	float newSpeed = 1.0f;
+
+	// if the player moves in the ball direction speed it up
+	if (player->velocity()*dir.y > 0)
+		newSpeed -= 0.2f;
+	else if (player->velocity()*dir.y < 0)
+		newSpeed += 0.2f;
+
+	double nAngle = dir.angle() + DK_PI*0.5;
+	double magic = mRandom.uniform() * 0.5 - 0.25;
+
+	dir.rotate((nAngle * 2)+magic);
+
+	// change the angle if the ball becomes horizontal
+	if (DkMath::distAngle(DkMath::normAngleRad(dir.angle(), 0.0, DK_PI), 0.0) > 0.01)
+		dir.rotate(0.6);
+
+	fixDirection(dir);
+
+	return newSpeed;
+}
+
+template <typename Vec>
+bool DkEngineBall::sweep(const QRect& player, const Vec& center, const Vec& dir, float& toi) const {
+
+	// grow the player by the ball (Minkowski sum) and intersect the ball's path with it
+	float hs = mRect.width()*0.5f;
+	float tEnter = -FLT_MAX;
+	float tExit = FLT_MAX;
+
+	float lo[2] = {player.left() - hs, player.top() - hs};
+	float hi[2] = {player.left() + player.width() + hs, player.top() + player.height() + hs};
+	float c[2] = {center.x, center.y};
+	float d[2] = {dir.x, dir.y};
+
+	for (int idx = 0; idx < 2; idx++) {
+
+		if (d[idx] == 0.0f) {
+			if (c[idx] < lo[idx] || c[idx] > hi[idx])
+				return false;
+			continue;
+		}
+
+		float t0 = (lo[idx] - c[idx]) / d[idx];
+		float t1 = (hi[idx] - c[idx]) / d[idx];
+
+		if (t0 > t1)
+			std::swap(t0, t1);
+
+		tEnter = qMax(tEnter, t0);
+		tExit = qMin(tExit, t1);
+	}
+
+	if (tEnter > tExit || tExit < 0.0f || tEnter > 1.0f)
+		return false;
+
+	// the ball already overlaps the player (e.g. the player moved into the ball)
+	toi = qMax(tEnter, 0.0f);
+
+	return true;
+}
+
+void DkEngineBall::setDirection(const Vec2f& dir) {
+
+	mDirection = dir;
+	fixDirection(mDirection);
+}
+
+template <typename Vec>
+void DkEngineBall::fixDirection(Vec& dir) const {
+
+	// check angle
+	fixAngle(dir);
+
+	if (dir.norm() > mMaxSpeed) {
+		dir.normalize();
+		dir *= (float)mMaxSpeed;
+	}
+	else if (mDirection.norm() < mMinSpeed) {
+		dir.normalize();
+		dir *= (float)mMinSpeed;
+	}
+}
+
+template <typename Vec>
+void DkEngineBall::fixAngle(Vec& dir) const {
+
+	double angle = dir.angle();
+	double range = DK_PI / 5.0;
+	double sign = angle > 0 ? 1.0 : -1.0;
+	angle = std::abs(angle);
+	double newAngle = 0.0;
+
+	if (angle < DK_PI*0.5 && angle > DK_PI*0.5 - range) {
+		newAngle = DK_PI*0.5 - range;
+	}
+	else if (angle > DK_PI*0.5 && angle < DK_PI*0.5 + range) {
+		newAngle = DK_PI*0.5 + range;
+	}
+
+	if (newAngle != 0.0) {
+		dir.rotate(mDirection.angle() - (newAngle*sign));
+	}
+}
+
+// DkEngineMatch --------------------------------------------------------------------
+DkEngineMatch::DkEngineMatch(QSharedPointer<DkEngineSettings> settings) :
+	mS(settings),
+	mBall(settings),
+	mPlayer1(settings),
+	mPlayer2(settings) {
+
+	setField(mS->field());
+}
+
+void DkEngineMatch::setField(const QRect& field) {
+
+	mS->setField(field);
+	mPlayer1.updateSize();
+	mPlayer2.updateSize();
+	mBall.updateSize();
+
+	newGame();
+}
+
+void DkEngineMatch::newGame() {
+
+	mPlayer1.resetScore();
+	mPlayer2.resetScore();
+	initRally();
+}
+
+void DkEngineMatch::newGame(quint64 seed) {
+
+	mBall.setSeed(seed);
+	newGame();
+}
+
+quint64 DkEngineMatch::seed() const {
+	return mBall.seed();
+}
+
+void DkEngineMatch::initRally() {
+
+	const QRect& f = mS->field();
+
+	mBall.reset();
+	mPlayer1.reset(QPoint(mS->unit(), qRound(f.height()*0.5f)));
+	mPlayer2.reset(QPoint(qRound(f.width()-mS->unit()*1.5f), qRound(f.height()*0.5f)));
+}
+
+DkEngineMatch::TickResult DkEngineMatch::step() {
+
+	mTicks++;
+
+	// same order as DkPongPort::gameLoop
+	if (!mBall.move(&mPlayer1, &mPlayer2)) {
+
+		initRally();
+
+		if (winner() != 0)
+			return tick_game_over;
+
+		return tick_point;
+	}
+
+	mPlayer1.move();
+	mPlayer2.move();
+
+	return tick_running;
+}
+
+int DkEngineMatch::winner() const {
+
+	if (mPlayer1.score() >= mS->totalScore())
+		return 1;
+	else if (mPlayer2.score() >= mS->totalScore())
+		return 2;
+
+	return 0;
+}
+
+quint64 DkEngineMatch::ticks() const {
+	return mTicks;
+}
+
+DkEngineBall& DkEngineMatch::ball() {
+	return mBall;
+}
+
+DkEnginePlayer& DkEngineMatch::player1() {
+	return mPlayer1;
+}
+
+DkEnginePlayer& DkEngineMatch::player2() {
+	return mPlayer2;
+}
+
+QSharedPointer<DkEngineSettings> DkEngineMatch::settings() const {
+	return mS;
+}
+
+int DkEngineMatch::playerSpeed() const {
+	return qRound(mS->field().width()*0.007);
+}
+
+}
@@ -0,0 +1,334 @@
+/*******************************************************************************************************
+
+ DkPongEngine.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QRect>
+#include <QSharedPointer>
+#include <climits>
+#pragma warning(pop)		// no warnings from includes - end
+
+#include "DkMath.h"
+#include "DkRandom.h"
+#include "DkInputFilter.h"
+#pragma warning(disable: 4251)
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+// The engine only depends on QtCore: no widgets, no audio and no QSettings I/O.
+// This allows for running the game logic on build servers without a display.
+
+namespace pong {
+
+/**
+ * Game parameters that are needed to run the simulation.
+ * DkPongSettings extends these by persistence and appearance.
+ **/
+class DllExport DkEngineSettings {
+
+public:
+	DkEngineSettings() {};
+	virtual ~DkEngineSettings() {};
+
+	void setField(const QRect& field);
+	QRect field() const;
+
+	void setUnit(int unit);
+	int unit() const;
+
+	void setTotalScore(int maxScore);
+	int totalScore() const;
+
+	void setPlayerRatio(float ratio);
+	float playerRatio() const;
+
+	void setSpeed(float speed);
+	float speed() const;
+
+	/**
+	 * Smooths & predicts the analogue controllers (see DkInputFilter).
+	 * @param filter if true, controller positions are filtered once per tick.
+	 **/
+	void setInputFilter(bool filter);
+	bool inputFilter() const;
+
+	// the game runs with 100 ticks per second (see DkFixedStep)
+	static const float tick_seconds;
+
+protected:
+	QRect mField;
+	int mUnit = 10;
+	int mTotalScore = 10;
+	float mSpeed = 30.0f;
+	float mPlayerRatio = 0.15f;
+	bool mInputFilter = false;
+};
+
+/**
+ * Everything that is needed to restore a player (e.g. when a replay starts).
+ **/
+struct DllExport DkPlayerState {
+	int top = 0;
+	int velocity = 0;
+	int speed = 0;
+	float controllerPos = -1.0f;
+};
+
+class DkEngineBall;
+
+class DllExport DkEnginePlayer {
+
+public:
+	DkEnginePlayer(QSharedPointer<DkEngineSettings> settings = QSharedPointer<DkEngineSettings>(new DkEngineSettings()));
+	virtual ~DkEnginePlayer() {};
+
+	void reset(const QPoint& pos);
+	QRect rect() const;
+	int pos() const;
+	void setHeight(int newHeight);
+
+	void move();
+	void setSpeed(int speed);
+	int speed() const;
+
+	void updateSize();
+	void increaseScore();
+
+	void resetScore();
+	int score() const;
+
+	void setPos(float pos);
+	float controllerPos() const;
+
+	int velocity() const;
+
+	DkPlayerState state() const;
+
+	/**
+	 * Restores a player. The input filter restarts
+	 * since its history is not part of the state.
+	 * @param state the player's state.
+	 **/
+	void setState(const DkPlayerState& state);
+	void resetFilter();
+
+	/**
+	 * Returns the controller's velocity estimated from all samples.
+	 * @return the velocity in pixel per tick (0 if the input filter is off).
+	 **/
+	float velocityEstimate() const;
+
+	/**
+	 * Simple bot that follows the ball with keyboard speed.
+	 * @param ball the ball.
+	 * @param speed the keyboard speed (see DkEngineMatch::playerSpeed).
+	 **/
+	void follow(const DkEngineBall& ball, int speed);
+
+protected:
+	int mSpeed = 0;
+	int mVelocity = 0;
+
+	int mScore = 0;
+	int mPos = INT_MAX;
+	float mControllerPos = -1.0f;
+
+	QSharedPointer<DkEngineSettings> mS;
+	QRect mRect;
+	DkInputFilter mFilter;
+
+	int controllerTop(float pos) const;
+};
+
+class DllExport DkEngineBall {
+
+public:
+	DkEngineBall(QSharedPointer<DkEngineSettings> settings = QSharedPointer<DkEngineSettings>(new DkEngineSettings()));
+	virtual ~DkEngineBall() {};
+
+	void reset();
+	void updateSize();
+
+	QRect rect() const;
+	QPoint direction() const;
+
+	void setSpeed(float val);
+	float speed() const;
+
+	void setAnalogueSpeed(float val);
+	float analogueSpeed(float val) const;
+
+	/**
+	 * Restarts the ball's random generator and picks a new direction.
+	 * Two balls with the same seed (and inputs) play the same match.
+	 * @param seed the match seed.
+	 **/
+	void setSeed(quint64 seed);
+	quint64 seed() const;
+
+	/**
+	 * Advances the ball by one tick.
+	 * Collisions are swept: walls and players are hit at their exact
+	 * time of impact and several bounces can happen in one tick.
+	 * @param player1 the left player.
+	 * @param player2 the right player.
+	 * @return false if a player scored in this tick.
+	 **/
+	bool move(DkEnginePlayer* player1, DkEnginePlayer* player2);
+
+	/**
+	 * Advances the ball by one tick with DkVector instead of Vec2f.
+	 * It runs the same physics as move() and is the baseline
+	 * of pong-sim --bench-vector.
+	 * @param player1 the left player.
+	 * @param player2 the right player.
+	 * @return false if a player scored in this tick.
+	 **/
+	bool moveReference(DkEnginePlayer* player1, DkEnginePlayer* player2);
+
+	/**
+	 * Returns the player that was hit in the last tick.
+	 * @return the player or 0 if the ball did not hit a player.
+	 **/
+	const DkEnginePlayer* lastHit() const;
+
+protected:
+	int mMinSpeed = 5;
+	int mMaxSpeed = 50;
+	float mSpeed = 3.0f;
+
+	enum Collision {
+		collision_none = 0,
+		collision_wall,
+		collision_player1,
+		collision_player2,
+		collision_left,
+		collision_right,
+
+		collision_end
+	};
+
+	// more collisions per tick are only possible in corners
+	static const int max_collisions = 4;
+
+	Vec2f mDirection = Vec2f(0.0f, 0.0f);
+	Vec2f mCenter = Vec2f(0.0f, 0.0f);	// sub-pixel ball center (mRect is rounded)
+	QRect mRect;
+	int mRally = 0;
+	const DkEnginePlayer* mLastHit = 0;
+	DkRandom mRandom;
+
+	QSharedPointer<DkEngineSettings> mS;
+
+	Vec2f randomDirection();
+
+	// the physics is written once for Vec2f (move) and DkVector (moveReference)
+	template <typename Vec> bool moveBall(DkEnginePlayer* player1, DkEnginePlayer* player2);
+	template <typename Vec> void fixAngle(Vec& dir) const;
+	template <typename Vec> void fixDirection(Vec& dir) const;
+	void setDirection(const Vec2f& dir);
+
+	/**
+	 * Swept AABB test of the ball against a player.
+	 * @param player the player's rect.
+	 * @param center the ball's center.
+	 * @param dir the ball's displacement in this tick.
+	 * @param toi the time of impact in [0 1] if the ball hits the player.
+	 * @return true if the ball hits the player in this tick.
+	 **/
+	template <typename Vec> bool sweep(const QRect& player, const Vec& center, const Vec& dir, float& toi) const;
+	template <typename Vec> float changeDirPlayer(const DkEnginePlayer* player, Vec& dir);
+};
+
+/**
+ * A complete match (ball & two players) without any GUI.
+ * It mirrors the game flow of DkPongPort::gameLoop.
+ **/
+class DllExport DkEngineMatch {
+
+public:
+	DkEngineMatch(QSharedPointer<DkEngineSettings> settings = QSharedPointer<DkEngineSettings>(new DkEngineSettings()));
+
+	enum TickResult {
+		tick_running = 0,
+		tick_point,
+		tick_game_over,
+
+		tick_end
+	};
+
+	/**
+	 * Resizes the field and resets the match.
+	 * @param field the new field.
+	 **/
+	void setField(const QRect& field);
+
+	void newGame();
+	void initRally();
+
+	/**
+	 * Seeds the ball and starts a new game.
+	 * @param seed the match seed (see DkRandom::matchSeed).
+	 **/
+	void newGame(quint64 seed);
+	quint64 seed() const;
+
+	/**
+	 * Advances the match by one tick.
+	 * @return tick_point if somebody scored, tick_game_over if somebody won.
+	 **/
+	TickResult step();
+
+	int winner() const;
+	quint64 ticks() const;
+
+	DkEngineBall& ball();
+	DkEnginePlayer& player1();
+	DkEnginePlayer& player2();
+	QSharedPointer<DkEngineSettings> settings() const;
+
+	int playerSpeed() const;
+
+protected:
+	QSharedPointer<DkEngineSettings> mS;
+
+	DkEngineBall mBall;
+	DkEnginePlayer mPlayer1;
+	DkEnginePlayer mPlayer2;
+
+	quint64 mTicks = 0;
+};
+
+}
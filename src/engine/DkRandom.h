@@ -0,0 +1,131 @@
+/*******************************************************************************************************
+
+ DkRandom.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QtGlobal>
+#pragma warning(pop)		// no warnings from includes - end
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+namespace pong {
+
+/**
+ * Small & fast seedable random number generator (PCG32, see pcg-random.org).
+ * Each ball (or match) owns its generator so that matches can be replayed
+ * and simulated in parallel without sharing global state (qrand).
+ **/
+class DllExport DkRandom {
+
+public:
+	DkRandom(quint64 seed = 0) {
+		setSeed(seed);
+	};
+
+	/**
+	 * Restarts the generator.
+	 * Different seeds select different streams.
+	 * @param seed the seed.
+	 **/
+	void setSeed(quint64 seed) {
+
+		mSeed = seed;
+		mState = 0;
+		mInc = (splitMix(seed) << 1) | 1u;
+		next();
+		mState += seed;
+		next();
+	};
+
+	quint64 seed() const {
+		return mSeed;
+	};
+
+	/**
+	 * Returns the next random number.
+	 * @return a number in [0 2^32).
+	 **/
+	quint32 next() {
+
+		quint64 old = mState;
+		mState = old * 6364136223846793005ULL + mInc;
+		quint32 xorShifted = (quint32)(((old >> 18u) ^ old) >> 27u);
+		quint32 rot = (quint32)(old >> 59u);
+
+		return (xorShifted >> rot) | (xorShifted << ((0u - rot) & 31u));
+	};
+
+	/**
+	 * Returns a uniformly distributed number.
+	 * @return a number in [0 1).
+	 **/
+	float uniform() {
+		return (next() >> 8) * (1.0f / 16777216.0f);
+	};
+
+	/**
+	 * Returns the seed of a match derived from a base seed.
+	 * This way, a whole session is reproducible from one seed.
+	 * @param seed the base seed (e.g. from the command line).
+	 * @param match the match index.
+	 * @return the match's seed.
+	 **/
+	static quint64 matchSeed(quint64 seed, quint64 match) {
+		return splitMix(seed + match * 0x9E3779B97F4A7C15ULL);
+	};
+
+	/**
+	 * Returns a seed from the system's entropy.
+	 **/
+	static quint64 randomSeed();
+
+	/**
+	 * SplitMix64 (used to decorrelate seeds).
+	 **/
+	static quint64 splitMix(quint64 x) {
+
+		x += 0x9E3779B97F4A7C15ULL;
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+		return x ^ (x >> 31);
+	};
+
+protected:
+	quint64 mState = 0;
+	quint64 mInc = 1;
+	quint64 mSeed = 0;
+};
+
+}
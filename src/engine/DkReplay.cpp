@@ -0,0 +1,404 @@
+/*******************************************************************************************************
+
+ DkReplay.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#include "DkReplay.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QtEndian>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <cstring>
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+const char DkReplay::magic[4] = {'D', 'K', 'P', 'R'};
+
+static const quint8 end_of_tick = 0x80;
+static const quint8 max_run = 0x7f;
+
+// little endian helpers --------------------------------------------------------------------
+template <typename T>
+static void put(QByteArray& data, T value) {
+
+	uchar buf[sizeof(T)];
+	qToLittleEndian<T>(value, buf);
+	data.append((const char*)buf, sizeof(T));
+}
+
+static void putFloat(QByteArray& data, float value) {
+
+	quint32 bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	put<quint32>(data, bits);
+}
+
+template <typename T>
+static T get(const uchar* data, qint64& pos) {
+
+	T value = qFromLittleEndian<T>(data + pos);
+	pos += sizeof(T);
+
+	return value;
+}
+
+static float getFloat(const uchar* data, qint64& pos) {
+
+	quint32 bits = get<quint32>(data, pos);
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+static void putPlayer(QByteArray& data, const DkPlayerState& s) {
+
+	put<qint32>(data, s.top);
+	put<qint32>(data, s.velocity);
+	put<qint32>(data, s.speed);
+	putFloat(data, s.controllerPos);
+}
+
+static DkPlayerState getPlayer(const uchar* data, qint64& pos) {
+
+	DkPlayerState s;
+	s.top = get<qint32>(data, pos);
+	s.velocity = get<qint32>(data, pos);
+	s.speed = get<qint32>(data, pos);
+	s.controllerPos = getFloat(data, pos);
+
+	return s;
+}
+
+// DkReplayHeader --------------------------------------------------------------------
+void DkReplayHeader::toSettings(DkEngineSettings& settings) const {
+
+	settings.setField(QRect(0, 0, fieldWidth, fieldHeight));
+	settings.setUnit(unit);
+	settings.setTotalScore(totalScore);
+	settings.setPlayerRatio(playerRatio);
+	settings.setSpeed(speed);
+	settings.setInputFilter(inputFilter);
+}
+
+void DkReplayHeader::fromSettings(const DkEngineSettings& settings) {
+
+	fieldWidth = settings.field().width();
+	fieldHeight = settings.field().height();
+	unit = settings.unit();
+	totalScore = settings.totalScore();
+	playerRatio = settings.playerRatio();
+	speed = settings.speed();
+	inputFilter = settings.inputFilter();
+}
+
+// DkReplayWriter --------------------------------------------------------------------
+void DkReplayWriter::start(const DkReplayHeader& header) {
+
+	mHeader = header;
+	mHeader.ticks = 0;
+	mHeader.complete = false;
+	mData.clear();
+	mData.reserve(64*1024);
+	mRunIdx = -1;
+	mRecording = true;
+}
+
+bool DkReplayWriter::isRecording() const {
+	return mRecording;
+}
+
+void DkReplayWriter::addInput(DkReplay::Input input, float value) {
+
+	if (!mRecording)
+		return;
+
+	mData.append((char)input);
+	putFloat(mData, value);
+	mRunIdx = -1;
+}
+
+void DkReplayWriter::endTick() {
+
+	if (!mRecording)
+		return;
+
+	mHeader.ticks++;
+
+	// extend the current run of ticks without inputs
+	if (mRunIdx != -1 && ((quint8)mData[mRunIdx] & max_run) < max_run) {
+		mData[mRunIdx] = (char)((quint8)mData[mRunIdx] + 1);
+		return;
+	}
+
+	mRunIdx = mData.size();
+	mData.append((char)end_of_tick);
+}
+
+quint32 DkReplayWriter::ticks() const {
+	return mHeader.ticks;
+}
+
+QByteArray DkReplayWriter::headerData() const {
+
+	QByteArray data;
+	data.reserve(DkReplay::header_size);
+
+	data.append(DkReplay::magic, sizeof(DkReplay::magic));
+	put<quint16>(data, DkReplay::version);
+	put<quint16>(data, DkReplay::header_size);
+	put<quint64>(data, mHeader.seed);
+
+	put<qint32>(data, mHeader.fieldWidth);
+	put<qint32>(data, mHeader.fieldHeight);
+	put<qint32>(data, mHeader.unit);
+	put<qint32>(data, mHeader.totalScore);
+	putFloat(data, mHeader.playerRatio);
+	putFloat(data, mHeader.speed);
+
+	putPlayer(data, mHeader.player1);
+	putPlayer(data, mHeader.player2);
+
+	put<quint32>(data, mHeader.ticks);
+	put<qint32>(data, mHeader.score1);
+	put<qint32>(data, mHeader.score2);
+	put<quint32>(data, mHeader.complete ? 1u : 0u);
+	put<quint32>(data, mHeader.inputFilter ? 1u : 0u);
+
+	Q_ASSERT(data.size() == DkReplay::header_size);
+
+	return data;
+}
+
+QByteArray DkReplayWriter::finish(int score1, int score2) {
+
+	if (!mRecording)
+		return QByteArray();
+
+	mRecording = false;
+	mHeader.score1 = score1;
+	mHeader.score2 = score2;
+	mHeader.complete = true;
+
+	QByteArray replay = headerData();
+	replay.append(mData);
+	mData.clear();
+
+	return replay;
+}
+
+bool DkReplayWriter::write(const QString& filePath, const QByteArray& replay) {
+
+	if (replay.isEmpty())
+		return false;
+
+	QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+	// the file is replaced on commit - a short write never leaves a broken replay behind
+	QSaveFile file(filePath);
+
+	if (!file.open(QIODevice::WriteOnly)) {
+		qWarning() << "cannot write replay to" << filePath << ":" << file.errorString();
+		return false;
+	}
+
+	if (file.write(replay) != replay.size() || !file.commit()) {
+		qWarning() << "cannot write replay to" << filePath << ":" << file.errorString();
+		return false;
+	}
+
+	return true;
+}
+
+void DkReplayWriter::discard() {
+
+	mRecording = false;
+	mData.clear();
+}
+
+// DkReplayReader --------------------------------------------------------------------
+DkReplayReader::~DkReplayReader() {
+	close();
+}
+
+bool DkReplayReader::open(const QString& filePath) {
+
+	close();
+	mFile.setFileName(filePath);
+
+	if (!mFile.open(QIODevice::ReadOnly)) {
+		qWarning() << "cannot open replay" << filePath << ":" << mFile.errorString();
+		return false;
+	}
+
+	mSize = mFile.size();
+	mData = mFile.map(0, mSize);
+
+	if (!mData || !readHeader()) {
+		qWarning() << filePath << "is not a valid replay";
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void DkReplayReader::close() {
+
+	if (mData)
+		mFile.unmap(const_cast<uchar*>(mData));
+
+	if (mFile.isOpen())
+		mFile.close();
+
+	mData = 0;
+	mSize = 0;
+	mPos = 0;
+	mIdleTicks = 0;
+}
+
+bool DkReplayReader::isOpen() const {
+	return mData != 0;
+}
+
+bool DkReplayReader::readHeader() {
+
+	if (mSize < DkReplay::header_size || std::memcmp(mData, DkReplay::magic, sizeof(DkReplay::magic)) != 0)
+		return false;
+
+	qint64 pos = sizeof(DkReplay::magic);
+	quint16 version = get<quint16>(mData, pos);
+	quint16 headerSize = get<quint16>(mData, pos);
+
+	if (version > DkReplay::version || headerSize < DkReplay::header_size || headerSize > mSize) {
+		qWarning() << "unsupported replay version" << version;
+		return false;
+	}
+
+	DkReplayHeader& h = mHeader;
+	h.seed = get<quint64>(mData, pos);
+	h.fieldWidth = get<qint32>(mData, pos);
+	h.fieldHeight = get<qint32>(mData, pos);
+	h.unit = get<qint32>(mData, pos);
+	h.totalScore = get<qint32>(mData, pos);
+	h.playerRatio = getFloat(mData, pos);
+	h.speed = getFloat(mData, pos);
+	h.player1 = getPlayer(mData, pos);
+	h.player2 = getPlayer(mData, pos);
+	h.ticks = get<quint32>(mData, pos);
+	h.score1 = get<qint32>(mData, pos);
+	h.score2 = get<qint32>(mData, pos);
+	h.complete = get<quint32>(mData, pos) != 0;
+	h.inputFilter = get<quint32>(mData, pos) != 0;
+
+	// newer versions may append fields to the header
+	mPos = headerSize;
+
+	return true;
+}
+
+void DkReplayReader::rewind() {
+
+	if (!isOpen())
+		return;
+
+	readHeader();
+	mIdleTicks = 0;
+}
+
+const DkReplayHeader& DkReplayReader::header() const {
+	return mHeader;
+}
+
+bool DkReplayReader::apply(DkEnginePlayer* player1, DkEnginePlayer* player2, DkEngineBall* ball) {
+
+	if (mIdleTicks > 0) {
+		mIdleTicks--;
+		return true;
+	}
+
+	while (mPos < mSize) {
+
+		quint8 op = mData[mPos++];
+
+		if (op & end_of_tick) {
+			mIdleTicks = op & max_run;
+			return true;
+		}
+
+		if (mPos + (qint64)sizeof(float) > mSize)
+			break;
+
+		float value = getFloat(mData, mPos);
+
+		switch (op) {
+		case DkReplay::input_player1_pos:	player1->setPos(value);			break;
+		case DkReplay::input_player2_pos:	player2->setPos(value);			break;
+		case DkReplay::input_player1_speed:	player1->setSpeed(qRound(value));	break;
+		case DkReplay::input_player2_speed:	player2->setSpeed(qRound(value));	break;
+		case DkReplay::input_ball_speed:	ball->setSpeed(value);				break;
+		default:
+			qWarning() << "corrupt replay: unknown input" << op << "at" << mPos-1;
+			mPos = mSize;
+			break;
+		}
+	}
+
+	return false;
+}
+
+void DkReplayReader::init(DkEngineMatch& match) const {
+
+	QSharedPointer<DkEngineSettings> s = match.settings();
+	mHeader.toSettings(*s);
+
+	match.setField(s->field());
+	match.newGame(mHeader.seed);
+	match.player1().setState(mHeader.player1);
+	match.player2().setState(mHeader.player2);
+}
+
+quint64 DkReplayReader::play(DkEngineMatch& match) {
+
+	rewind();
+	init(match);
+
+	quint64 ticks = 0;
+
+	while (apply(&match.player1(), &match.player2(), &match.ball())) {
+
+		ticks++;
+
+		if (match.step() == DkEngineMatch::tick_game_over)
+			break;
+	}
+
+	return ticks;
+}
+
+}
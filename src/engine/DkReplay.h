@@ -0,0 +1,204 @@
+/*******************************************************************************************************
+
+ DkReplay.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#pragma warning(pop)		// no warnings from includes - end
+
+#include "DkPongEngine.h"
+#pragma warning(disable: 4251)
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+// Replay files (little endian):
+// header:	"DKPR", version, header size, seed, settings snapshot,
+//			initial player states, ticks & final score, input filter
+// body:	a stream of inputs - each tick's inputs are terminated by an end-of-tick byte
+//			0x01 - 0x05 input (see DkReplay::Input) followed by its value (4 bytes)
+//			0x80 | n	end of n+1 ticks (ticks without inputs are run-length encoded)
+
+namespace pong {
+
+/**
+ * Everything that is stored in front of a replay's inputs.
+ **/
+struct DllExport DkReplayHeader {
+
+	quint64 seed = 0;
+
+	// settings snapshot
+	int fieldWidth = 0;
+	int fieldHeight = 0;
+	int unit = 10;
+	int totalScore = 10;
+	float playerRatio = 0.15f;
+	float speed = 30.0f;
+	bool inputFilter = false;
+
+	DkPlayerState player1;
+	DkPlayerState player2;
+
+	// result (written when the match is finished)
+	quint32 ticks = 0;
+	int score1 = 0;
+	int score2 = 0;
+	bool complete = false;
+
+	void toSettings(DkEngineSettings& settings) const;
+	void fromSettings(const DkEngineSettings& settings);
+};
+
+class DllExport DkReplay {
+
+public:
+	enum Input {
+		input_none = 0,
+		input_player1_pos,		// DkEnginePlayer::setPos
+		input_player2_pos,
+		input_player1_speed,	// DkEnginePlayer::setSpeed
+		input_player2_speed,
+		input_ball_speed,		// DkEngineBall::setSpeed
+
+		input_end
+	};
+
+	static const char magic[4];
+	static const quint16 version = 1;
+	static const int header_size = 92;
+};
+
+/**
+ * Records the inputs of a match.
+ * The replay is kept in memory. finish() hands it over so that
+ * write() can run in a background thread (the game loop never waits for the disk).
+ **/
+class DllExport DkReplayWriter {
+
+public:
+	DkReplayWriter() {};
+
+	/**
+	 * Starts a new recording (a running recording is discarded).
+	 * @param header the seed, settings and players at the start of the match.
+	 **/
+	void start(const DkReplayHeader& header);
+	bool isRecording() const;
+
+	void addInput(DkReplay::Input input, float value);
+	void endTick();
+
+	/**
+	 * Finishes the recording.
+	 * @param score1 the final score of player 1.
+	 * @param score2 the final score of player 2.
+	 * @return the replay file's content (empty if nothing was recorded).
+	 **/
+	QByteArray finish(int score1, int score2);
+
+	/**
+	 * Writes a replay (thread-safe). The file is only created if all data was written.
+	 * @param filePath the replay's file path - missing directories are created.
+	 * @param replay the replay (see finish).
+	 * @return true if the replay was written.
+	 **/
+	static bool write(const QString& filePath, const QByteArray& replay);
+
+	/**
+	 * Stops the recording without writing it.
+	 **/
+	void discard();
+
+	quint32 ticks() const;
+
+protected:
+	bool mRecording = false;
+	DkReplayHeader mHeader;
+	QByteArray mData;
+	int mRunIdx = -1;	// index of the last end-of-tick byte if no input followed
+
+	QByteArray headerData() const;
+};
+
+/**
+ * Plays replays from memory-mapped files.
+ **/
+class DllExport DkReplayReader {
+
+public:
+	DkReplayReader() {};
+	~DkReplayReader();
+
+	bool open(const QString& filePath);
+	void close();
+	bool isOpen() const;
+	void rewind();
+
+	const DkReplayHeader& header() const;
+
+	/**
+	 * Applies the inputs of the next tick.
+	 * Call it before each step of the simulation.
+	 * @return false if the replay is over.
+	 **/
+	bool apply(DkEnginePlayer* player1, DkEnginePlayer* player2, DkEngineBall* ball);
+
+	/**
+	 * Re-simulates the whole replay.
+	 * @param match the match, its settings are overwritten by the replay's settings.
+	 * @return the number of ticks simulated.
+	 **/
+	quint64 play(DkEngineMatch& match);
+
+	/**
+	 * Prepares a match (settings, seed, players) to play the replay.
+	 **/
+	void init(DkEngineMatch& match) const;
+
+protected:
+	QFile mFile;
+	const uchar* mData = 0;
+	qint64 mSize = 0;
+	qint64 mPos = 0;
+	int mIdleTicks = 0;
+
+	DkReplayHeader mHeader;
+
+	bool readHeader();
+};
+
+}
@@ -0,0 +1,140 @@
+/*******************************************************************************************************
+
+ DkSerialParser.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#include "DkSerialParser.h"
+
+namespace pong {
+
+// DkSerialParser --------------------------------------------------------------------
+DkSerialParser::DkSerialParser(quint64 pinMask) {
+	mPinMask = pinMask;
+}
+
+void DkSerialParser::setPinMask(quint64 pinMask) {
+	mPinMask = pinMask;
+}
+
+char* DkSerialParser::writeBuffer(int& size) {
+
+	int tailIdx = (int)(mTail & (buffer_size-1));
+	int free = buffer_size - available();
+
+	// the free space might wrap around
+	size = qMin(free, buffer_size - tailIdx);
+
+	return mBuffer + tailIdx;
+}
+
+void DkSerialParser::commit(int size) {
+	mTail += size;
+}
+
+int DkSerialParser::available() const {
+	return (int)(mTail - mHead);
+}
+
+bool DkSerialParser::isSynced() const {
+	return mSynced;
+}
+
+quint8 DkSerialParser::at(int offset) const {
+	return (quint8)mBuffer[(mHead + offset) & (buffer_size-1)];
+}
+
+bool DkSerialParser::isFrame(int offset, quint16& value) const {
+
+	if (at(offset) != frame_marker)
+		return false;
+
+	value = (quint16)(at(offset+1) | (at(offset+2) << 8));
+	int pin = value >> 10;
+
+	return (mPinMask & (1ull << pin)) != 0;
+}
+
+void DkSerialParser::skip(int size) {
+	mHead += size;
+}
+
+int DkSerialParser::parse(std::vector<quint16>& frames) {
+
+	int numFrames = 0;
+
+	while (available() >= frame_size) {
+
+		quint16 value = 0;
+
+		if (!isFrame(0, value)) {
+
+			// we lost sync: drop one byte and look for the next marker
+			if (mSynced)
+				mResyncs++;
+
+			mSynced = false;
+			mBadBytes++;
+			skip(1);
+			continue;
+		}
+
+		// payload bytes can be 42 too - so the next marker has to confirm the frame
+		if (!mSynced) {
+
+			if (available() < 2*frame_size)
+				break;	// wait for more data
+
+			quint16 next = 0;
+			if (!isFrame(frame_size, next)) {
+				mBadBytes++;
+				skip(1);
+				continue;
+			}
+
+			mSynced = true;
+		}
+
+		frames.push_back(value);
+		numFrames++;
+		skip(frame_size);
+	}
+
+	mFrames += numFrames;
+
+	return numFrames;
+}
+
+quint64 DkSerialParser::frames() const {
+	return mFrames;
+}
+
+quint64 DkSerialParser::badBytes() const {
+	return mBadBytes;
+}
+
+quint64 DkSerialParser::resyncs() const {
+	return mResyncs;
+}
+
+}
@@ -0,0 +1,119 @@
+/*******************************************************************************************************
+
+ DkSerialParser.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QtGlobal>
+#include <vector>
+#pragma warning(pop)		// no warnings from includes - end
+
+#pragma warning(disable: 4251)
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+namespace pong {
+
+/**
+ * Decodes the controller's serial stream.
+ * A frame is the marker 42 followed by a little endian unsigned short
+ * (pin << 10 | value) - see src/Arduino/controller/controller.ino.
+ * Bytes are read in bulk into a ring buffer and all complete frames are
+ * decoded at once. If the parser loses sync, it skips byte by byte and only
+ * accepts a frame if the next frame's marker confirms it.
+ **/
+class DllExport DkSerialParser {
+
+public:
+	enum {
+		frame_marker = 42,
+		frame_size = 3,
+		buffer_size = 4096,		// must be a power of 2
+
+		// pins 0-5 (analog) and 7 (power button)
+		default_pins = 0xBF
+	};
+
+	DkSerialParser(quint64 pinMask = default_pins);
+
+	/**
+	 * Only frames with pins in this mask are valid.
+	 * @param pinMask bit i is set if pin i is valid.
+	 **/
+	void setPinMask(quint64 pinMask);
+
+	/**
+	 * Returns the contiguous free space of the ring buffer.
+	 * @param size the number of bytes that can be written.
+	 * @return a pointer to the free space.
+	 **/
+	char* writeBuffer(int& size);
+
+	/**
+	 * Marks bytes of writeBuffer() as written.
+	 * @param size the number of bytes written.
+	 **/
+	void commit(int size);
+
+	/**
+	 * Decodes all complete frames.
+	 * @param frames the decoded frames are appended to this vector.
+	 * @return the number of frames decoded.
+	 **/
+	int parse(std::vector<quint16>& frames);
+
+	bool isSynced() const;
+	int available() const;
+
+	quint64 frames() const;
+	quint64 badBytes() const;
+	quint64 resyncs() const;
+
+protected:
+	char mBuffer[buffer_size];
+	quint64 mHead = 0;		// read position
+	quint64 mTail = 0;		// write position
+	quint64 mPinMask = default_pins;
+	bool mSynced = false;
+
+	quint64 mFrames = 0;
+	quint64 mBadBytes = 0;
+	quint64 mResyncs = 0;
+
+	quint8 at(int offset) const;
+	bool isFrame(int offset, quint16& value) const;
+	void skip(int size);
+};
+
+}
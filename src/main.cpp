@@ -28,11 +28,13 @@
 #pragma warning(push, 0)	// no warnings from includes
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QFileInfo>
 #pragma warning(pop)
 
 #include "DkPong.h"
 #include "DkSettings.h"
 #include "DkArduinoController.h"
+#include "DkLeaderboard.h"
 
 int main(int argc, char** argv) {
 	
@@ -60,6 +62,12 @@ int main(int argc, char** argv) {
 		QObject::tr("com"));
 	parser.addOption(comOpt);
 
+	// set baud rate
+	QCommandLineOption baudOpt(QStringList() << "b" << "baud",
+		QObject::tr("Read the com port with <baud> baud (default: 9600)."),
+		QObject::tr("baud"));
+	parser.addOption(baudOpt);
+
 	// set player name
 	QCommandLineOption p1NameOpt("player1",
 		QObject::tr("Player 1 <name>."),
@@ -78,9 +86,58 @@ int main(int argc, char** argv) {
 		QObject::tr("<score>"));
 	parser.addOption(scoreOpt);
 
+	// set random seed
+	QCommandLineOption seedOpt("seed",
+		QObject::tr("Base <seed> of the ball's random generator (the seed of each match is printed)."),
+		QObject::tr("<seed>"));
+	parser.addOption(seedOpt);
+
+	// replays
+	QCommandLineOption replayOpt(QStringList() << "r" << "replay",
+		QObject::tr("Watch the recorded match <file>."),
+		QObject::tr("<file>"));
+	parser.addOption(replayOpt);
+
+	QCommandLineOption replayDirOpt("replay-dir",
+		QObject::tr("Record all matches to <dir> (default: app data/replays, empty disables recording)."),
+		QObject::tr("<dir>"));
+	parser.addOption(replayDirOpt);
+
+	QCommandLineOption noRenderThreadOpt("no-render-thread",
+		QObject::tr("Render the frames in the GUI thread."));
+	parser.addOption(noRenderThreadOpt);
+
+	QCommandLineOption perfOverlayOpt("perf-overlay",
+		QObject::tr("Show the performance overlay (toggle it with F3)."));
+	parser.addOption(perfOverlayOpt);
+
+	// latency
+	QCommandLineOption latencyOpt("latency-log",
+		QObject::tr("Write the controller's input latency histograms to <file> (CSV) when Pong is closed."),
+		QObject::tr("<file>"));
+	parser.addOption(latencyOpt);
+
+	// leaderboard
+	QCommandLineOption rebuildOpt("rebuild-leaderboard",
+		QObject::tr("Recompute the leaderboard (player_stats) from all scores and quit."));
+	parser.addOption(rebuildOpt);
+
 	parser.process(app);
 	// CMD parser --------------------------------------------------------------------
 
+	if (parser.isSet(rebuildOpt)) {
+
+		QFileInfo dbInfo(QApplication::applicationDirPath(), pong::DkPongSettings().DBPath());
+		quint64 games = 0;
+
+		if (!pong::DkLeaderboard::rebuild(dbInfo.absoluteFilePath(), &games)) {
+			qInfo() << "could not rebuild the leaderboard of" << dbInfo.absoluteFilePath();
+			return 1;
+		}
+
+		qInfo() << "leaderboard rebuilt from" << games << "games";
+		return 0;
+	}
 
 	pong::DkPong* pw = new pong::DkPong();
 	
@@ -95,6 +152,16 @@ int main(int argc, char** argv) {
 		controller->setComPort(parser.value(comOpt));
 	}
 
+	if (parser.isSet(baudOpt)) {
+		bool baudOk = false;
+		int baud = parser.value(baudOpt).toInt(&baudOk);
+
+		if (baudOk)
+			controller->setBaudRate(baud);
+		else
+			qInfo() << baudOpt.names()[0] << "must be a number";
+	}
+
 	if (!parser.value(p1NameOpt).isEmpty())
 		pw->viewport()->player1()->setName(parser.value(p1NameOpt));
 
@@ -108,6 +175,27 @@ int main(int argc, char** argv) {
 	else if (parser.isSet(scoreOpt))
 		qInfo() << scoreOpt.names()[0] << "must be a number";
 
+	quint64 seed = parser.value(seedOpt).toULongLong(&ok, 0);
+	if (ok)
+		pw->viewport()->setSeed(seed);
+	else if (parser.isSet(seedOpt))
+		qInfo() << seedOpt.names()[0] << "must be a number";
+
+	if (parser.isSet(noRenderThreadOpt))
+		pw->viewport()->setRenderThread(false);
+
+	if (parser.isSet(perfOverlayOpt))
+		pw->viewport()->setPerfOverlay(true);
+
+	if (parser.isSet(latencyOpt))
+		pw->viewport()->setLatencyLog(parser.value(latencyOpt));
+
+	if (parser.isSet(replayDirOpt))
+		pw->viewport()->setReplayDir(parser.value(replayDirOpt));
+
+	if (parser.isSet(replayOpt) && !pw->viewport()->playReplay(parser.value(replayOpt)))
+		qInfo() << "could not load replay" << parser.value(replayOpt);
+
 	pw->viewport()->start();
 
 	// run pong
@@ -0,0 +1,285 @@
+/*******************************************************************************************************
+
+ DkRenderer.cpp
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+
+#include "DkRenderer.h"
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QPainter>
+#include <QFontMetrics>
+#include <QVector>
+#pragma warning(pop)		// no warnings from includes - end
+
+namespace pong {
+
+// DkFrameText --------------------------------------------------------------------
+bool DkFrameText::operator==(const DkFrameText& o) const {
+	return text == o.text && rect == o.rect && align == o.align && clear == o.clear;
+}
+
+bool DkFrameText::operator!=(const DkFrameText& o) const {
+	return !(*this == o);
+}
+
+// DkFrameState --------------------------------------------------------------------
+bool DkFrameState::sameLayout(const DkFrameState& o) const {
+
+	return size == o.size &&
+		devicePixelRatio == o.devicePixelRatio &&
+		background == o.background &&
+		foreground == o.foreground &&
+		unit == o.unit &&
+		texts == o.texts;
+}
+
+// DkFrameRenderer --------------------------------------------------------------------
+DkFrameRenderer::DkFrameRenderer() : mTexts(16*1024) {	// the cost is in KB
+}
+
+QImage DkFrameRenderer::render(const DkFrameState& state) {
+
+	QImage image;
+	render(state, image);
+
+	return image;
+}
+
+void DkFrameRenderer::render(const DkFrameState& state, QImage& image) {
+
+	QSize size = state.size * state.devicePixelRatio;
+
+	if (image.size() != size || image.format() != QImage::Format_ARGB32_Premultiplied)
+		image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+	image.setDevicePixelRatio(state.devicePixelRatio);
+
+	QPainter p(&image);
+
+	// static layer: background & net
+	p.setCompositionMode(QPainter::CompositionMode_Source);
+	p.drawImage(QPoint(), fieldLayer(state));
+	p.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+	for (const QRect& r : state.objects)
+		p.fillRect(r, state.foreground);
+
+	// clear area under text
+	for (const DkFrameText& t : state.texts) {
+
+		if (!t.clear)
+			continue;
+
+		p.fillRect(t.rect, state.foreground);
+		p.setCompositionMode(QPainter::CompositionMode_SourceIn);
+		p.fillRect(t.rect, state.background);
+		p.setCompositionMode(QPainter::CompositionMode_SourceOver);
+	}
+
+	for (const DkFrameText& t : state.texts) {
+
+		QImage img = text(state, t);
+
+		if (img.isNull())
+			continue;
+
+		QRect r = textRect(img.size(), t.rect.size(), t.align, state.unit);
+		p.drawImage(r.translated(t.rect.topLeft()), img);
+	}
+}
+
+const QImage& DkFrameRenderer::fieldLayer(const DkFrameState& state) {
+
+	QSize size = state.size * state.devicePixelRatio;
+
+	// the layer only changes if the window is resized or the settings are changed
+	if (mField.size() != size ||
+		mFieldBg != state.background ||
+		mFieldFg != state.foreground ||
+		mFieldUnit != state.unit) {
+
+		mFieldBg = state.background;
+		mFieldFg = state.foreground;
+		mFieldUnit = state.unit;
+
+		mField = QImage(size, QImage::Format_ARGB32_Premultiplied);
+		mField.setDevicePixelRatio(state.devicePixelRatio);
+		mField.fill(Qt::transparent);
+
+		QPainter p(&mField);
+		p.fillRect(QRect(QPoint(), state.size), mFieldBg);
+		drawField(p, state.size, mFieldFg, mFieldUnit);
+	}
+
+	return mField;
+}
+
+QImage DkFrameRenderer::text(const DkFrameState& state, const DkFrameText& text) {
+
+	QString key = textKey(text.text, text.rect.size(), state.foreground, state.unit);
+
+	if (QImage* cached = mTexts.object(key))
+		return *cached;
+
+	QImage img = renderText(text.text, text.rect.size(), state.foreground, state.unit);
+
+	// insert() takes ownership (and deletes images that are too large)
+	mTexts.insert(key, new QImage(img), qMax(img.bytesPerLine()*img.height()/1024, 1));
+
+	return img;
+}
+
+QRect DkFrameRenderer::labelRect(Label label, const QSize& size, int unit) {
+
+	switch (label) {
+	case label_score1:
+	case label_score2: {
+		QRect sR(QPoint(0, unit*3), QSize(qRound(size.width()*0.5), qRound(size.height()*0.15)));
+
+		if (label == label_score2)
+			sR.moveLeft(qRound(size.width()*0.5));
+
+		return sR;
+	}
+	case label_large_info: {
+		QRect lIR(QPoint(qRound(size.width()*0.15),0), QSize(qRound(size.width()*0.7), qRound(size.height()*0.15)));
+		lIR.moveBottom(qRound(size.height()*0.5 + unit));
+		return lIR;
+	}
+	case label_small_info: {
+		QRect sIR(QPoint(qRound(size.width()*0.15),0), QSize(qRound(size.width()*0.7), qRound(size.height()*0.08)));
+		sIR.moveTop(qRound(size.height()*0.5 + unit*2));
+		return sIR;
+	}
+	default:
+		return QRect();
+	}
+}
+
+Qt::Alignment DkFrameRenderer::labelAlignment(Label label) {
+
+	switch (label) {
+	case label_score1:		return Qt::AlignRight;
+	case label_score2:		return Qt::AlignLeft;
+	case label_large_info:	return Qt::AlignHCenter | Qt::AlignBottom;
+	case label_small_info:	return Qt::AlignHCenter;
+	default:				return Qt::AlignLeft;
+	}
+}
+
+DkFrameText DkFrameRenderer::labelText(Label label, const QString& text, const QSize& size, int unit) {
+
+	DkFrameText t;
+	t.text = text;
+	t.rect = labelRect(label, size, unit);
+	t.align = labelAlignment(label);
+
+	// the net is cleared below the info labels
+	t.clear = label == label_large_info || label == label_small_info;
+
+	return t;
+}
+
+void DkFrameRenderer::drawField(QPainter& p, const QSize& size, const QColor& color, int unit) {
+
+	QPen cPen = p.pen();
+	
+	// set dash pattern
+	QVector<qreal> dashes;
+	dashes << 0.1 << 3;
+
+	// create style
+	QPen linePen;
+	linePen.setColor(color);
+	linePen.setWidth(qRound(unit*0.5));
+	linePen.setDashPattern(dashes);
+	p.setPen(linePen);
+
+	// set line
+	QLine line(QPoint(qRound(size.width()*0.5f), 0), QPoint(qRound(size.width()*0.5f), size.height()));
+	p.drawLine(line);
+
+	p.setPen(cPen);
+}
+
+QImage DkFrameRenderer::renderText(const QString& text, const QSize& labelSize, const QColor& color, int unit) {
+
+	if (text.isEmpty())
+		return QImage();
+
+	QFont f = font();
+	QFontMetrics m(f);
+
+	QImage buffer(m.width(text)-1, m.height(), QImage::Format_ARGB32_Premultiplied);
+	buffer.fill(Qt::transparent);
+
+	// draw font
+	QPen fontPen(color);
+
+	QPainter bp(&buffer);
+	bp.setPen(fontPen);
+	bp.setFont(f);
+	bp.drawText(buffer.rect(), Qt::AlignHCenter | Qt::AlignVCenter, text);
+	bp.end();
+
+	QSize bSize(labelSize);
+	bSize.setHeight(qRound(bSize.height() - unit*0.5));
+
+	return buffer.scaled(bSize, Qt::KeepAspectRatio);
+}
+
+QRect DkFrameRenderer::textRect(const QSize& textSize, const QSize& labelSize, Qt::Alignment align, int unit) {
+
+	QRect r(QPoint(), textSize);
+
+	if (align & Qt::AlignRight)
+		r.moveLeft(labelSize.width() - (unit * 3 + textSize.width()));
+	else if (align & Qt::AlignHCenter)
+		r.moveLeft(qRound((labelSize.width() - textSize.width())*0.5f));
+	else
+		r.moveLeft(unit * 3);
+
+	if (align & Qt::AlignBottom)
+		r.moveBottom(labelSize.height());
+	else
+		r.moveTop(qRound((labelSize.height()-textSize.height())/2.0f));	// default: center
+
+	return r;
+}
+
+QString DkFrameRenderer::textKey(const QString& text, const QSize& labelSize, const QColor& color, int unit) {
+
+	// the text goes last - it might contain anything
+	return QString("%1x%2|%3|%4|")
+		.arg(labelSize.width())
+		.arg(labelSize.height())
+		.arg(color.rgba())
+		.arg(unit) + text;
+}
+
+QFont DkFrameRenderer::font() {
+	return QFont("terminal", 6);
+}
+
+}
@@ -0,0 +1,202 @@
+/*******************************************************************************************************
+
+ DkRenderer.h
+ Created on:	18.10.2026
+
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board.
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes - begin
+#include <QImage>
+#include <QColor>
+#include <QRect>
+#include <QFont>
+#include <QCache>
+#include <vector>
+#pragma warning(pop)		// no warnings from includes - end
+
+#pragma warning(disable: 4251)
+
+#ifndef DllExport
+#ifdef DK_DLL_EXPORT
+#define DllExport Q_DECL_EXPORT
+#elif DK_DLL_IMPORT
+#define DllExport Q_DECL_IMPORT
+#else
+#define DllExport
+#endif
+#endif
+
+// The renderer only depends on QtGui: no widgets. Frames can be rendered
+// in a worker thread or without a display (QT_QPA_PLATFORM=offscreen).
+
+class QPainter;
+
+namespace pong {
+
+/**
+ * A text label of a frame (scores & info texts).
+ **/
+struct DllExport DkFrameText {
+
+	QString text;
+	QRect rect;									// the label's geometry
+	Qt::Alignment align = Qt::AlignLeft;
+	bool clear = false;							// clear the net below the label
+
+	bool operator==(const DkFrameText& o) const;
+	bool operator!=(const DkFrameText& o) const;
+};
+
+/**
+ * Immutable snapshot of everything that is visible in a frame.
+ * It is copied to the render thread - so it must not reference the game.
+ **/
+class DllExport DkFrameState {
+
+public:
+	enum Object {
+		object_ball = 0,
+		object_player1,
+		object_player2,
+
+		object_end
+	};
+
+	QSize size;
+	qreal devicePixelRatio = 1.0;
+
+	QColor background = QColor(0, 0, 0, 100);
+	QColor foreground = QColor(255, 255, 255);
+	int unit = 10;
+
+	quint64 tick = 0;	// the game tick the objects are from
+	QRect objects[object_end];
+	std::vector<DkFrameText> texts;
+
+	/**
+	 * Compares everything but the moving objects.
+	 * @param o the other frame.
+	 * @return true if both frames have the same size, colours & texts.
+	 **/
+	bool sameLayout(const DkFrameState& o) const;
+};
+
+/**
+ * Draws DkFrameStates into QImages.
+ * The static functions are shared with the widgets (DkPongPort & DkScoreLabel)
+ * so that all paths look the same. An instance is not thread-safe
+ * (it caches the field & texts) - use one per thread.
+ **/
+class DllExport DkFrameRenderer {
+
+public:
+	DkFrameRenderer();
+
+	enum Label {
+		label_score1 = 0,
+		label_score2,
+		label_large_info,
+		label_small_info,
+
+		label_end
+	};
+
+	/**
+	 * Returns the geometry of a label.
+	 * @param label the label.
+	 * @param size the size of the field.
+	 * @param unit the game's unit.
+	 * @return the label's rect.
+	 **/
+	static QRect labelRect(Label label, const QSize& size, int unit);
+	static Qt::Alignment labelAlignment(Label label);
+
+	/**
+	 * Creates a label's text for a frame.
+	 * @param label the label.
+	 * @param text the label's text.
+	 * @param size the size of the field.
+	 * @param unit the game's unit.
+	 * @return the text.
+	 **/
+	static DkFrameText labelText(Label label, const QString& text, const QSize& size, int unit);
+
+	/**
+	 * Renders a frame.
+	 * @param state the frame.
+	 * @param image the target - it is (re-)allocated if its size does not fit.
+	 **/
+	void render(const DkFrameState& state, QImage& image);
+	QImage render(const DkFrameState& state);
+
+	/**
+	 * Draws the net.
+	 * @param p the painter.
+	 * @param size the size of the field.
+	 * @param color the net's colour.
+	 * @param unit the game's unit.
+	 **/
+	static void drawField(QPainter& p, const QSize& size, const QColor& color, int unit);
+
+	/**
+	 * Renders a label's text scaled to the label's height.
+	 * @param text the text.
+	 * @param labelSize the size of the label.
+	 * @param color the text colour.
+	 * @param unit the game's unit.
+	 * @return the text image.
+	 **/
+	static QImage renderText(const QString& text, const QSize& labelSize, const QColor& color, int unit);
+
+	/**
+	 * Returns where a rendered text is placed in its label.
+	 * @param textSize the size of the rendered text.
+	 * @param labelSize the size of the label.
+	 * @param align the label's alignment.
+	 * @param unit the game's unit.
+	 * @return the text's rect in label coordinates.
+	 **/
+	static QRect textRect(const QSize& textSize, const QSize& labelSize, Qt::Alignment align, int unit);
+
+	/**
+	 * Key of a rendered text (see renderText).
+	 **/
+	static QString textKey(const QString& text, const QSize& labelSize, const QColor& color, int unit);
+
+	static QFont font();
+
+protected:
+	QImage mField;
+	QColor mFieldBg;
+	QColor mFieldFg;
+	int mFieldUnit = 0;
+
+	QCache<QString, QImage> mTexts;
+
+	const QImage& fieldLayer(const DkFrameState& state);
+	QImage text(const DkFrameState& state, const DkFrameText& text);
+};
+
+}
@@ -0,0 +1,404 @@
+/*******************************************************************************************************
+ 
+ main.cpp (pong-sim)
+ Created on:	18.10.2026
+ 
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board. 
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <cmath>
+#pragma warning(pop)
+
+#include "engine/DkPongEngine.h"
+#include "engine/DkBatchEngine.h"
+#include "engine/DkBallKernel.h"
+#include "engine/DkReplay.h"
+
+namespace pong {
+
+/**
+ * Calls DkEngineBall::move (or the DkVector reference) in a tight loop.
+ * @return the time per call in ns.
+ **/
+double benchMove(DkEngineMatch& match, bool reference, int iterations) {
+
+	DkEngineBall& ball = match.ball();
+	DkEnginePlayer* p1 = &match.player1();
+	DkEnginePlayer* p2 = &match.player2();
+
+	QElapsedTimer dt;
+	dt.start();
+
+	for (int idx = 0; idx < iterations; idx++) {
+
+		bool running = reference ? ball.moveReference(p1, p2) : ball.move(p1, p2);
+
+		if (!running)
+			ball.reset();
+	}
+
+	return (double)dt.nsecsElapsed() / iterations;
+}
+
+/**
+ * Measures DkEngineBall::move (Vec2f) against DkEngineBall::moveReference (DkVector).
+ **/
+void benchVector(QTextStream& out) {
+
+	const int iterations = 10000000;
+	const quint64 seed = 42;
+
+	// the ball writes its speed to the settings, so every match gets its own
+	QSharedPointer<DkEngineSettings> dkS(new DkEngineSettings());
+	dkS->setField(QRect(0, 0, 1280, 720));
+	DkEngineMatch dkMatch(dkS);
+	dkMatch.newGame(seed);
+	double dkNs = benchMove(dkMatch, true, iterations);
+
+	QSharedPointer<DkEngineSettings> vS(new DkEngineSettings());
+	vS->setField(QRect(0, 0, 1280, 720));
+	DkEngineMatch vMatch(vS);
+	vMatch.newGame(seed);
+	double vNs = benchMove(vMatch, false, iterations);
+
+	// both have to play the same match
+	bool same = dkMatch.ball().rect() == vMatch.ball().rect() &&
+		dkMatch.player1().score() == vMatch.player1().score() &&
+		dkMatch.player2().score() == vMatch.player2().score();
+
+	out << "DkEngineBall::moveReference (DkVector): " << dkNs << " ns/call\n";
+	out << "DkEngineBall::move (Vec2f):             " << vNs << " ns/call (" << (vNs > 0 ? dkNs / vNs : 0.0) << "x)\n";
+
+	if (!same)
+		out << "WARNING: DkEngineBall::move and moveReference diverged\n";
+}
+
+/**
+ * Compares a vectorized ball kernel with the scalar reference.
+ * @param isa the kernel - it has to be available (see DkBallKernel::available).
+ * @return the number of balls that differ.
+ **/
+int verifyKernel(const DkEngineSettings& settings, quint64 seed, DkBallKernel::InstructionSet isa, QTextStream& out) {
+
+	// an odd number of matches tests the scalar tail too
+	DkBatchEngine batch(settings, 1021);
+	batch.setSeed(seed);
+	std::vector<quint8> simdEvents(batch.size());
+	std::vector<quint8> scalarEvents(batch.size());
+	const float eps = 1e-4f;
+	int errors = 0;
+
+	for (int tIdx = 0; tIdx < 2000; tIdx++) {
+
+		DkBatchState simd = batch.state();
+		DkBatchState scalar = batch.state();
+
+		if (isa == DkBallKernel::isa_avx2)
+			DkBallKernel::stepAvx2(batch.kernelParams(), simd, 0, simd.size(), simdEvents.data());
+		else
+			DkBallKernel::stepSse4(batch.kernelParams(), simd, 0, simd.size(), simdEvents.data());
+		DkBallKernel::stepScalar(batch.kernelParams(), scalar, 0, scalar.size(), scalarEvents.data());
+
+		for (int idx = 0; idx < simd.size(); idx++) {
+
+			if (simdEvents[idx] != scalarEvents[idx] ||
+				std::abs(simd.ballX[idx] - scalar.ballX[idx]) > eps ||
+				std::abs(simd.ballY[idx] - scalar.ballY[idx]) > eps ||
+				std::abs(simd.dirX[idx] - scalar.dirX[idx]) > eps ||
+				std::abs(simd.dirY[idx] - scalar.dirY[idx]) > eps) {
+
+				if (errors < 10)
+					out << DkBallKernel::name(isa) << " tick " << tIdx << " ball " << idx << ": simd (" << simd.ballX[idx] << ", " << simd.ballY[idx] << ") event " << (int)simdEvents[idx]
+						<< " != scalar (" << scalar.ballX[idx] << ", " << scalar.ballY[idx] << ") event " << (int)scalarEvents[idx] << "\n";
+				errors++;
+			}
+		}
+
+		batch.step();
+	}
+
+	return errors;
+}
+
+}
+
+int main(int argc, char** argv) {
+
+	QCoreApplication::setOrganizationName("Vienna University of Technology");
+	QCoreApplication::setOrganizationDomain("http://www.nomacs.org");
+	QCoreApplication::setApplicationName("pong-sim");
+
+	QCoreApplication app(argc, argv);
+
+	// CMD parser --------------------------------------------------------------------
+	QCommandLineParser parser;
+
+	parser.setApplicationDescription("Headless Pong simulation");
+	parser.addHelpOption();
+
+	QCommandLineOption ticksOpt(QStringList() << "t" << "ticks",
+		QObject::tr("Simulate <ticks> ticks (default: 1000000)."),
+		QObject::tr("ticks"), "1000000");
+	parser.addOption(ticksOpt);
+
+	QCommandLineOption widthOpt("width",
+		QObject::tr("Field <width> in pixel (default: 1280)."),
+		QObject::tr("width"), "1280");
+	parser.addOption(widthOpt);
+
+	QCommandLineOption heightOpt("height",
+		QObject::tr("Field <height> in pixel (default: 720)."),
+		QObject::tr("height"), "720");
+	parser.addOption(heightOpt);
+
+	QCommandLineOption unitOpt(QStringList() << "u" << "unit",
+		QObject::tr("Ball size <unit> in pixel (default: 10)."),
+		QObject::tr("unit"), "10");
+	parser.addOption(unitOpt);
+
+	QCommandLineOption speedOpt("speed",
+		QObject::tr("Initial ball <speed> (default: 30)."),
+		QObject::tr("speed"), "30");
+	parser.addOption(speedOpt);
+
+	QCommandLineOption scoreOpt(QStringList() << "s" << "score",
+		QObject::tr("Set maximum <score> (default: 10)."),
+		QObject::tr("score"), "10");
+	parser.addOption(scoreOpt);
+
+	QCommandLineOption matchesOpt(QStringList() << "m" << "matches",
+		QObject::tr("Simulate <matches> matches at once with the batch engine. --ticks are counted per match."),
+		QObject::tr("matches"));
+	parser.addOption(matchesOpt);
+
+	QCommandLineOption seedOpt("seed",
+		QObject::tr("Base <seed> of the random generators (default: random). Match i uses a seed derived from it."),
+		QObject::tr("seed"));
+	parser.addOption(seedOpt);
+
+	QCommandLineOption logMatchesOpt("log-matches",
+		QObject::tr("Print the seed and result of every finished match."));
+	parser.addOption(logMatchesOpt);
+
+	QCommandLineOption replayOpt(QStringList() << "r" << "replay",
+		QObject::tr("Re-simulate the recorded match <file> and compare its result."),
+		QObject::tr("file"));
+	parser.addOption(replayOpt);
+
+	QCommandLineOption verifyOpt("verify-kernel",
+		QObject::tr("Compare the vectorized ball kernel with the scalar reference."));
+	parser.addOption(verifyOpt);
+
+	QCommandLineOption benchVecOpt("bench-vector",
+		QObject::tr("Measure DkEngineBall::move with Vec2f against the DkVector reference."));
+	parser.addOption(benchVecOpt);
+
+	parser.process(app);
+	// CMD parser --------------------------------------------------------------------
+
+	QTextStream out(stdout);
+
+	quint64 numTicks = parser.value(ticksOpt).toULongLong();
+	QRect field(0, 0, parser.value(widthOpt).toInt(), parser.value(heightOpt).toInt());
+
+	if (numTicks == 0 || field.isEmpty()) {
+		out << "illegal arguments - see --help\n";
+		return 1;
+	}
+
+	QSharedPointer<pong::DkEngineSettings> s(new pong::DkEngineSettings());
+	s->setField(field);
+	s->setUnit(parser.value(unitOpt).toInt());
+	s->setSpeed(parser.value(speedOpt).toFloat());
+	s->setTotalScore(parser.value(scoreOpt).toInt());
+
+	bool seedOk = true;
+	quint64 seed = parser.isSet(seedOpt) ? parser.value(seedOpt).toULongLong(&seedOk, 0) : pong::DkRandom::randomSeed();
+
+	if (!seedOk) {
+		out << "illegal seed - see --help\n";
+		return 1;
+	}
+
+	if (parser.isSet(benchVecOpt)) {
+		pong::benchVector(out);
+		return 0;
+	}
+
+	// replay --------------------------------------------------------------------
+	if (parser.isSet(replayOpt)) {
+
+		pong::DkReplayReader replay;
+
+		if (!replay.open(parser.value(replayOpt))) {
+			out << "cannot open replay " << parser.value(replayOpt) << "\n";
+			return 1;
+		}
+
+		// the replay's settings overwrite the command line settings
+		pong::DkEngineMatch match(s);
+
+		QElapsedTimer dt;
+		dt.start();
+
+		quint64 ticks = replay.play(match);
+
+		double sec = dt.nsecsElapsed() / 1e9;
+		const pong::DkReplayHeader& h = replay.header();
+		bool same = ticks == h.ticks && match.player1().score() == h.score1 && match.player2().score() == h.score2;
+
+		// the game runs with 100 ticks per second
+		double gameSec = ticks / 100.0;
+
+		out << "seed:       " << h.seed << "\n";
+		out << "field:      " << h.fieldWidth << " x " << h.fieldHeight << "\n";
+		out << "ticks:      " << ticks << " (recorded: " << h.ticks << ")\n";
+		out << "score:      " << match.player1().score() << " : " << match.player2().score()
+			<< " (recorded: " << h.score1 << " : " << h.score2 << (h.complete ? "" : ", incomplete") << ")\n";
+		out << "time:       " << sec << " sec\n";
+		out << "realtime:   " << (sec > 0 ? gameSec / sec : 0.0) << "x\n";
+		out << (same ? "replay matches the recording\n" : "FAILED: replay diverged from the recording\n");
+
+		return same ? 0 : 1;
+	}
+
+	if (parser.isSet(verifyOpt)) {
+
+		int errors = 0;
+		int verified = 0;
+
+		out << "seed: " << seed << "\n";
+
+		// check every kernel the CPU can run - not only the one step() picks
+		for (int idx = pong::DkBallKernel::isa_sse4; idx < pong::DkBallKernel::isa_end; idx++) {
+
+			pong::DkBallKernel::InstructionSet isa = (pong::DkBallKernel::InstructionSet)idx;
+
+			if (!pong::DkBallKernel::available(isa))
+				continue;
+
+			int e = pong::verifyKernel(*s, seed, isa, out);
+			out << pong::DkBallKernel::name(isa) << ": " << (e ? "FAILED: " : "passed: ") << e << " mismatches\n";
+			errors += e;
+			verified++;
+		}
+
+		if (!verified)
+			out << "skipped: no vectorized kernel is compiled (see SIMD_KERNEL) or supported by this CPU\n";
+
+		return errors ? 1 : 0;
+	}
+
+	// batch simulation --------------------------------------------------------------------
+	if (parser.isSet(matchesOpt)) {
+
+		int numMatches = parser.value(matchesOpt).toInt();
+
+		if (numMatches <= 0) {
+			out << "illegal number of matches - see --help\n";
+			return 1;
+		}
+
+		pong::DkBatchEngine batch(*s, numMatches);
+		batch.setSeed(seed);
+
+		QElapsedTimer dt;
+		dt.start();
+
+		batch.run(numTicks);
+
+		double sec = dt.nsecsElapsed() / 1e9;
+		double matchTicks = (double)numTicks * numMatches;
+
+		if (parser.isSet(logMatchesOpt)) {
+
+			const pong::DkBatchState& bs = batch.state();
+
+			for (int idx = 0; idx < bs.size(); idx++)
+				out << "match " << idx << " seed " << bs.seed[idx] << " wins " << bs.wins1[idx] << " : " << bs.wins2[idx] << "\n";
+		}
+
+		out << "seed:             " << seed << "\n";
+		out << "kernel:           " << pong::DkBallKernel::instructionSet() << "\n";
+		out << "matches:          " << numMatches << "\n";
+		out << "ticks per match:  " << numTicks << "\n";
+		out << "points:           " << batch.points() << "\n";
+		out << "games:            " << batch.games() << "\n";
+		out << "time:             " << sec << " sec\n";
+		out << "match-ticks/sec:  " << (sec > 0 ? matchTicks / sec : 0.0) << "\n";
+
+		return 0;
+	}
+
+	pong::DkEngineMatch match(s);
+	int playerSpeed = match.playerSpeed();
+
+	quint64 games = 0;
+	quint64 points = 0;
+	quint64 wins[2] = {0, 0};
+	bool logMatches = parser.isSet(logMatchesOpt);
+
+	match.newGame(pong::DkRandom::matchSeed(seed, games));
+
+	QElapsedTimer dt;
+	dt.start();
+
+	for (quint64 idx = 0; idx < numTicks; idx++) {
+
+		match.player1().follow(match.ball(), playerSpeed);
+		match.player2().follow(match.ball(), playerSpeed);
+
+		switch (match.step()) {
+		case pong::DkEngineMatch::tick_point:
+			points++;
+			break;
+		case pong::DkEngineMatch::tick_game_over:
+			points++;
+			games++;
+			wins[match.winner()-1]++;
+
+			if (logMatches)
+				out << "match " << games-1 << " seed " << match.seed() << " winner " << match.winner()
+					<< " (" << match.player1().score() << " : " << match.player2().score() << ")\n";
+
+			match.newGame(pong::DkRandom::matchSeed(seed, games));
+			break;
+		default:
+			break;
+		}
+	}
+
+	double sec = dt.nsecsElapsed() / 1e9;
+
+	out << "seed:       " << seed << "\n";
+	out << "ticks:      " << numTicks << "\n";
+	out << "points:     " << points << "\n";
+	out << "games:      " << games << " (" << wins[0] << " : " << wins[1] << ")\n";
+	out << "time:       " << sec << " sec\n";
+	out << "ticks/sec:  " << (sec > 0 ? numTicks / sec : 0.0) << "\n";
+
+	return 0;
+}
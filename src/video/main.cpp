@@ -0,0 +1,496 @@
+/*******************************************************************************************************
+ 
+ main.cpp (pong-render)
+ Created on:	18.10.2026
+ 
+ Pong is a homage to the famous arcade game Pong with the capability of old-school controllers using an Arduino Uno board. 
+
+ Copyright (C) 2015-2016 Markus Diem <markus@nomacs.org>
+
+ This file is part of Pong.
+
+ Pong is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ Pong is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*******************************************************************************************************/
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QPainter>
+#include <cmath>
+#include <cstdio>
+#pragma warning(pop)
+
+#include "engine/DkPongEngine.h"
+#include "engine/DkReplay.h"
+#include "render/DkRenderer.h"
+
+namespace pong {
+
+/**
+ * Streams frames as YUV4MPEG2 (4:2:0, full range BT.601) or as raw RGBA.
+ **/
+class DkVideoWriter {
+
+public:
+	enum Format {
+		format_y4m = 0,
+		format_rgba,
+
+		format_end
+	};
+
+	DkVideoWriter(QIODevice* device, Format format, const QSize& size, int fps) :
+		mDevice(device), mFormat(format), mSize(size), mFps(fps) {}
+
+	/**
+	 * Writes a frame.
+	 * @param frame a premultiplied ARGB32 image with the video's size.
+	 * @return false if the frame could not be written (e.g. the pipe was closed).
+	 **/
+	bool write(const QImage& frame) {
+
+		if (mFormat == format_y4m)
+			toY4m(frame);
+		else
+			toRgba(frame);
+
+		mFrames++;
+
+		return mDevice->write(mBuffer) == mBuffer.size();
+	}
+
+	quint64 frames() const {
+		return mFrames;
+	}
+
+protected:
+	QIODevice* mDevice = 0;
+	Format mFormat = format_y4m;
+	QSize mSize;
+	int mFps = 60;
+	quint64 mFrames = 0;
+	QByteArray mBuffer;
+
+	void toY4m(const QImage& frame) {
+
+		int w = mSize.width();
+		int h = mSize.height();
+		int cw = w / 2;
+		int ch = h / 2;
+
+		mBuffer.clear();
+
+		if (mFrames == 0)
+			mBuffer += QString("YUV4MPEG2 W%1 H%2 F%3:1 Ip A1:1 C420jpeg\n").arg(w).arg(h).arg(mFps).toLatin1();
+
+		mBuffer += "FRAME\n";
+		int offset = mBuffer.size();
+		mBuffer.resize(offset + w*h + 2*cw*ch);
+
+		uchar* yPlane = (uchar*)mBuffer.data() + offset;
+		uchar* uPlane = yPlane + w*h;
+		uchar* vPlane = uPlane + cw*ch;
+
+		// premultiplied colours are the frame composed over black
+		for (int y = 0; y < h; y++) {
+
+			const QRgb* row = (const QRgb*)frame.constScanLine(y);
+			uchar* yRow = yPlane + y*w;
+
+			for (int x = 0; x < w; x++)
+				yRow[x] = (uchar)((77*qRed(row[x]) + 150*qGreen(row[x]) + 29*qBlue(row[x]) + 128) >> 8);
+		}
+
+		for (int y = 0; y < ch; y++) {
+
+			const QRgb* r0 = (const QRgb*)frame.constScanLine(2*y);
+			const QRgb* r1 = (const QRgb*)frame.constScanLine(2*y+1);
+
+			for (int x = 0; x < cw; x++) {
+
+				int r = (qRed(r0[2*x]) + qRed(r0[2*x+1]) + qRed(r1[2*x]) + qRed(r1[2*x+1]) + 2) >> 2;
+				int g = (qGreen(r0[2*x]) + qGreen(r0[2*x+1]) + qGreen(r1[2*x]) + qGreen(r1[2*x+1]) + 2) >> 2;
+				int b = (qBlue(r0[2*x]) + qBlue(r0[2*x+1]) + qBlue(r1[2*x]) + qBlue(r1[2*x+1]) + 2) >> 2;
+
+				uPlane[y*cw + x] = (uchar)qBound(0, ((-43*r - 85*g + 128*b + 128) >> 8) + 128, 255);
+				vPlane[y*cw + x] = (uchar)qBound(0, ((128*r - 107*g - 21*b + 128) >> 8) + 128, 255);
+			}
+		}
+	}
+
+	void toRgba(const QImage& frame) {
+
+		// straight alpha - the window is translucent
+		QImage rgba = frame.convertToFormat(QImage::Format_RGBA8888);
+		int rowBytes = mSize.width() * 4;
+
+		mBuffer.resize(rowBytes * mSize.height());
+
+		for (int y = 0; y < mSize.height(); y++)
+			memcpy(mBuffer.data() + y*rowBytes, rgba.constScanLine(y), rowBytes);
+	}
+};
+
+/**
+ * Renders a match (replay or bots) at a fixed frame rate.
+ * The game runs with 100 ticks per second: frames between two ticks
+ * are interpolated just like in DkPongPort::paintEvent.
+ **/
+class DkMatchVideo {
+
+public:
+	DkMatchVideo(DkEngineMatch& match, DkVideoWriter& writer, const QSize& size, int fps) :
+		mMatch(match), mWriter(writer), mSize(size), mFps(fps) {
+
+		QSize field = match.settings()->field().size();
+
+		// the field keeps its aspect ratio
+		mScale = qMin((double)size.width() / field.width(), (double)size.height() / field.height());
+		QSize scaled = field * mScale;
+		mOffset = QPoint((size.width() - scaled.width()) / 2, (size.height() - scaled.height()) / 2);
+
+		mCanvas = QImage(size, QImage::Format_ARGB32_Premultiplied);
+		keepState();
+	}
+
+	void setNames(const QString& player1, const QString& player2) {
+		mNames[0] = player1;
+		mNames[1] = player2;
+	}
+
+	/**
+	 * Advances the video to the next frame's time.
+	 * @param step runs a tick and returns false if the match is over.
+	 * @return false if the match is over.
+	 **/
+	template <typename Step>
+	bool advance(Step step) {
+
+		double t = (double)mWriter.frames() / mFps / DkEngineSettings::tick_seconds;
+		quint64 target = (quint64)t;
+
+		while (mTicks < target) {
+
+			keepState();
+			DkEngineMatch::TickResult result = DkEngineMatch::tick_running;
+
+			if (!step(result))
+				return false;
+
+			mTicks++;
+
+			// no interpolation across a reset
+			if (result != DkEngineMatch::tick_running)
+				keepState();
+
+			if (result == DkEngineMatch::tick_game_over) {
+				mAlpha = 0.0;
+				return false;
+			}
+		}
+
+		mAlpha = t - (double)target;
+
+		return true;
+	}
+
+	/**
+	 * Renders the current state.
+	 * @param info the large info text (e.g. the winner).
+	 * @return false if the frame could not be written.
+	 **/
+	bool writeFrame(const QString& info = QString()) {
+
+		DkFrameState s = state(info);
+
+		mRenderer.render(s, mFrame);
+
+		if (mFrame.size() == mCanvas.size())
+			return mWriter.write(mFrame);
+
+		mCanvas.fill(Qt::transparent);
+		QPainter p(&mCanvas);
+		p.drawImage(QRect(mOffset, mFrame.size()), mFrame, mFrame.rect());
+		p.end();
+
+		return mWriter.write(mCanvas);
+	}
+
+	QString winnerText() const {
+		return QObject::tr("%1 won!").arg(mMatch.winner() == 2 ? mNames[1] : mNames[0]);
+	}
+
+protected:
+	DkEngineMatch& mMatch;
+	DkVideoWriter& mWriter;
+	QSize mSize;
+	int mFps = 60;
+
+	double mScale = 1.0;
+	QPoint mOffset;
+	quint64 mTicks = 0;
+	double mAlpha = 0.0;
+	QString mNames[2];
+
+	QRect mPrev[DkFrameState::object_end];
+
+	DkFrameRenderer mRenderer;
+	QImage mFrame;
+	QImage mCanvas;
+
+	void keepState() {
+		mPrev[DkFrameState::object_ball] = mMatch.ball().rect();
+		mPrev[DkFrameState::object_player1] = mMatch.player1().rect();
+		mPrev[DkFrameState::object_player2] = mMatch.player2().rect();
+	}
+
+	QRect interpolate(const QRect& prev, const QRect& cur) const {
+
+		// see DkPongPort::interpolate
+		if (mAlpha >= 1.0 || prev.size() != cur.size())
+			return cur;
+
+		QPointF tl = prev.topLeft() + QPointF(cur.topLeft() - prev.topLeft()) * mAlpha;
+
+		return QRect(tl.toPoint(), cur.size());
+	}
+
+	DkFrameState state(const QString& info) const {
+
+		const DkEngineSettings& es = *mMatch.settings();
+		QSize field = es.field().size();
+
+		DkFrameState s;
+		s.size = field;
+		s.devicePixelRatio = mScale;
+		s.unit = es.unit();
+
+		s.objects[DkFrameState::object_ball] = interpolate(mPrev[DkFrameState::object_ball], mMatch.ball().rect());
+		s.objects[DkFrameState::object_player1] = interpolate(mPrev[DkFrameState::object_player1], mMatch.player1().rect());
+		s.objects[DkFrameState::object_player2] = interpolate(mPrev[DkFrameState::object_player2], mMatch.player2().rect());
+
+		s.texts.push_back(DkFrameRenderer::labelText(DkFrameRenderer::label_score1, QString::number(mMatch.player1().score()), field, s.unit));
+		s.texts.push_back(DkFrameRenderer::labelText(DkFrameRenderer::label_score2, QString::number(mMatch.player2().score()), field, s.unit));
+
+		if (!info.isEmpty())
+			s.texts.push_back(DkFrameRenderer::labelText(DkFrameRenderer::label_large_info, info, field, s.unit));
+
+		return s;
+	}
+};
+
+}
+
+int main(int argc, char** argv) {
+
+	// no display needed
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+
+	QGuiApplication::setOrganizationName("Vienna University of Technology");
+	QGuiApplication::setOrganizationDomain("http://www.nomacs.org");
+	QGuiApplication::setApplicationName("pong-render");
+
+	QGuiApplication app(argc, argv);
+
+	// CMD parser --------------------------------------------------------------------
+	QCommandLineParser parser;
+
+	parser.setApplicationDescription("Renders Pong matches to raw video (Y4M or RGBA)");
+	parser.addHelpOption();
+
+	QCommandLineOption replayOpt(QStringList() << "r" << "replay",
+		QObject::tr("Render the recorded match <file> (default: a match of two bots)."),
+		QObject::tr("file"));
+	parser.addOption(replayOpt);
+
+	QCommandLineOption outputOpt(QStringList() << "o" << "output",
+		QObject::tr("Write the video to <file> (default: - for stdout)."),
+		QObject::tr("file"), "-");
+	parser.addOption(outputOpt);
+
+	QCommandLineOption formatOpt(QStringList() << "f" << "format",
+		QObject::tr("Video <format>: y4m or rgba (default: y4m or the output's suffix)."),
+		QObject::tr("format"));
+	parser.addOption(formatOpt);
+
+	QCommandLineOption widthOpt("width",
+		QObject::tr("Video <width> in pixel (default: 1280 or the replay's field)."),
+		QObject::tr("width"));
+	parser.addOption(widthOpt);
+
+	QCommandLineOption heightOpt("height",
+		QObject::tr("Video <height> in pixel (default: 720 or the replay's field)."),
+		QObject::tr("height"));
+	parser.addOption(heightOpt);
+
+	QCommandLineOption fpsOpt("fps",
+		QObject::tr("Frames per second (default: 60)."),
+		QObject::tr("fps"), "60");
+	parser.addOption(fpsOpt);
+
+	QCommandLineOption secondsOpt(QStringList() << "t" << "seconds",
+		QObject::tr("Stop after <seconds> of video (default: 0 - until the match is over)."),
+		QObject::tr("seconds"), "0");
+	parser.addOption(secondsOpt);
+
+	QCommandLineOption scoreOpt(QStringList() << "s" << "score",
+		QObject::tr("Set maximum <score> of bot matches (default: 10)."),
+		QObject::tr("score"), "10");
+	parser.addOption(scoreOpt);
+
+	QCommandLineOption seedOpt("seed",
+		QObject::tr("<seed> of bot matches (default: random)."),
+		QObject::tr("seed"));
+	parser.addOption(seedOpt);
+
+	parser.process(app);
+	// CMD parser --------------------------------------------------------------------
+
+	QTextStream err(stderr);
+
+	// format
+	QString outPath = parser.value(outputOpt);
+	QString formatName = parser.isSet(formatOpt) ? parser.value(formatOpt) : QFileInfo(outPath).suffix();
+	pong::DkVideoWriter::Format format = formatName.toLower() == "rgba" ? pong::DkVideoWriter::format_rgba : pong::DkVideoWriter::format_y4m;
+
+	if (parser.isSet(formatOpt) && formatName != "rgba" && formatName != "y4m") {
+		err << "illegal format " << formatName << " - see --help\n";
+		return 1;
+	}
+
+	int fps = parser.value(fpsOpt).toInt();
+	double seconds = parser.value(secondsOpt).toDouble();
+
+	// match
+	QSharedPointer<pong::DkEngineSettings> s(new pong::DkEngineSettings());
+	pong::DkEngineMatch match(s);
+	pong::DkReplayReader replay;
+
+	if (parser.isSet(replayOpt)) {
+
+		if (!replay.open(parser.value(replayOpt))) {
+			err << "cannot open replay " << parser.value(replayOpt) << "\n";
+			return 1;
+		}
+
+		replay.init(match);
+	}
+	else {
+		s->setTotalScore(parser.value(scoreOpt).toInt());
+		match.setField(QRect(0, 0, 1280, 720));
+	}
+
+	QSize field = s->field().size();
+	QSize size(parser.isSet(widthOpt) ? parser.value(widthOpt).toInt() : field.width(),
+		parser.isSet(heightOpt) ? parser.value(heightOpt).toInt() : field.height());
+
+	// bots play on the video's field
+	if (!replay.isOpen() && size != field) {
+		match.setField(QRect(QPoint(), size));
+		field = size;
+	}
+
+	if (fps <= 0 || size.isEmpty() || field.isEmpty()) {
+		err << "illegal arguments - see --help\n";
+		return 1;
+	}
+
+	if (format == pong::DkVideoWriter::format_y4m && (size.width() % 2 || size.height() % 2)) {
+		err << "y4m (4:2:0) needs an even width & height\n";
+		return 1;
+	}
+
+	bool seedOk = true;
+	quint64 seed = parser.isSet(seedOpt) ? parser.value(seedOpt).toULongLong(&seedOk, 0) : pong::DkRandom::randomSeed();
+
+	if (!seedOk) {
+		err << "illegal seed - see --help\n";
+		return 1;
+	}
+
+	if (!replay.isOpen())
+		match.newGame(pong::DkRandom::matchSeed(seed, 0));
+
+	// output
+	QFile out;
+	bool opened = outPath == "-" ? out.open(stdout, QIODevice::WriteOnly) : (out.setFileName(outPath), out.open(QIODevice::WriteOnly));
+
+	if (!opened) {
+		err << "cannot write to " << outPath << ": " << out.errorString() << "\n";
+		return 1;
+	}
+
+	pong::DkVideoWriter writer(&out, format, size, fps);
+	pong::DkMatchVideo video(match, writer, size, fps);
+	video.setNames(QObject::tr("Player 1"), QObject::tr("Player 2"));
+
+	int playerSpeed = match.playerSpeed();
+	quint64 maxFrames = seconds > 0 ? (quint64)std::ceil(seconds * fps) : 0;
+
+	auto step = [&](pong::DkEngineMatch::TickResult& result) {
+
+		if (replay.isOpen()) {
+			if (!replay.apply(&match.player1(), &match.player2(), &match.ball()))
+				return false;
+		}
+		else {
+			match.player1().follow(match.ball(), playerSpeed);
+			match.player2().follow(match.ball(), playerSpeed);
+		}
+
+		result = match.step();
+		return true;
+	};
+
+	QElapsedTimer dt;
+	dt.start();
+	bool ok = true;
+
+	while (ok && (!maxFrames || writer.frames() < maxFrames)) {
+
+		if (!video.advance(step))
+			break;
+
+		ok = video.writeFrame();
+	}
+
+	// show the winner for two seconds
+	if (match.winner() != 0) {
+		for (int idx = 0; ok && idx < 2*fps && (!maxFrames || writer.frames() < maxFrames); idx++)
+			ok = video.writeFrame(video.winnerText());
+	}
+
+	out.close();
+
+	double sec = dt.nsecsElapsed() / 1e9;
+	double videoSec = (double)writer.frames() / fps;
+
+	err << "seed:       " << (replay.isOpen() ? replay.header().seed : seed) << "\n";
+	err << "size:       " << size.width() << " x " << size.height() << " (" << (format == pong::DkVideoWriter::format_y4m ? "y4m" : "rgba") << ")\n";
+	err << "frames:     " << writer.frames() << " (" << videoSec << " sec)\n";
+	err << "score:      " << match.player1().score() << " : " << match.player2().score() << "\n";
+	err << "time:       " << sec << " sec\n";
+	err << "realtime:   " << (sec > 0 ? videoSec / sec : 0.0) << "x\n";
+
+	if (!ok)
+		err << "FAILED: the output was closed\n";
+
+	return ok ? 0 : 1;
+}